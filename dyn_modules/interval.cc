@@ -2,7 +2,31 @@
 #include "Singular/blackbox.h"
 #include "interval.h"
 #include "Singular/ipshell.h" // for iiCheckTypes
+#include "Singular/lists.h"
 #include "Singular/links/ssiLink.h"
+#include "misc/intvec.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <stdint.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utime.h>
+#include <vector>
+
+/*
+ * COUNTERS
+ */
+
+intervalCounters ivCounters = {0, 0, 0};
 
 /*
  * CONSTRUCTORS & DESTRUCTORS
@@ -12,17 +36,17 @@
 
 interval::interval()
 {
-    lower = nInit(0);
-    upper = nInit(0);
     R = currRing;
+    lower = n_Init(0, R->cf);
+    upper = n_Init(0, R->cf);
     R->ref++;
 }
 
 interval::interval(number a)
 {
-    lower = a;
-    upper = nCopy(a);
     R = currRing;
+    lower = a;
+    upper = n_Copy(a, R->cf);
     R->ref++;
 }
 
@@ -34,33 +58,48 @@ interval::interval(number a, number b)
     R->ref++;
 }
 
+interval::interval(number a, number b, ring S)
+{
+    lower = a;
+    upper = b;
+    R = S;
+    R->ref++;
+}
+
 interval::interval(interval *I)
 {
-    lower = nCopy(I->lower);
-    upper = nCopy(I->upper);
+    lower = n_Copy(I->lower, I->R->cf);
+    upper = n_Copy(I->upper, I->R->cf);
     R = I->R;
     R->ref++;
 }
 
 interval::~interval()
 {
-    nDelete(&lower);
-    nDelete(&upper);
+    n_Delete(&lower, R->cf);
+    n_Delete(&upper, R->cf);
     R->ref--;
 }
 
 /* box */
 
-box::box()
+box::box() : box(currRing)
 {
-    R = currRing;
+}
+
+// the box [0,0]^N of S
+box::box(ring S)
+{
+    ivCounters.boxes++;
+    R = S;
     int i, n = R->N;
     intervals = (interval**) omAlloc0(n * sizeof(interval*));
     if (intervals != NULL)
     {
         for (i = 0; i < n; i++)
         {
-            intervals[i] = new interval();
+            intervals[i] = new interval(n_Init(0, R->cf), n_Init(0, R->cf),
+                R);
         }
     }
     R->ref++;
@@ -68,6 +107,7 @@ box::box()
 
 box::box(box* B)
 {
+    ivCounters.boxes++;
     R = B->R;
     int i, n = R->N;
     intervals = (interval**) omAlloc0(n * sizeof(interval*));
@@ -103,12 +143,77 @@ box& box::setInterval(int i, interval *I)
     return *this;
 }
 
+/* boxlist */
+
+boxlist::boxlist(ring S)
+{
+    d = new boxlistData;
+    d->R = S;
+    d->ref = 1;
+    S->ref++;
+}
+
+boxlist::boxlist(boxlist *L)
+{
+    d = L->d;
+    d->ref++;
+}
+
+boxlist::~boxlist()
+{
+    if (--d->ref > 0)
+    {
+        return;
+    }
+    singularEndpoint e(d->R->cf);
+    for (boxlistInterval &I : d->ivs)
+    {
+        ivcore::release(e, I);
+    }
+    d->R->ref--;
+    delete d;
+}
+
+void boxlist::append(const box *B)
+{
+    assume(d->ref == 1);
+    for (int i = 0; i < d->R->N; i++)
+    {
+        d->ivs.push_back(ivcore::make<singularEndpoint>(
+            n_Copy(B->intervals[i]->lower, d->R->cf),
+            n_Copy(B->intervals[i]->upper, d->R->cf)));
+    }
+}
+
+void boxlist::append(const boxlistInterval *B)
+{
+    assume(d->ref == 1);
+    singularEndpoint e(d->R->cf);
+    for (int i = 0; i < d->R->N; i++)
+    {
+        d->ivs.push_back(ivcore::copy(e, B[i]));
+    }
+}
+
+box* boxlist::get(int j) const
+{
+    const boxlistInterval *B = (*this)[j];
+    box *RES = new box(d->R);
+    for (int i = 0; i < d->R->N; i++)
+    {
+        RES->setInterval(i, new interval(n_Copy(B[i].lower, d->R->cf),
+            n_Copy(B[i].upper, d->R->cf), d->R));
+    }
+    return RES;
+}
+
 /*
  * TYPE IDs
  */
 
 int intervalID;
 int boxID;
+int boxlistID;
 
 /*
  * INTERVAL FUNCTIONS
@@ -243,149 +348,77 @@ BOOLEAN length(leftv result, leftv arg)
     if (arg != NULL && arg->Typ() == intervalID)
     {
         interval *I = (interval*) arg->Data();
+        singularEndpoint e(I->R->cf);
+        result->rtyp = NUMBER_CMD;
+        result->data = (void*) ivcore::width(e, *I);
+        arg->CleanUp();
+        return FALSE;
+    }
+    // maximal length of the intervals of a box
+    if (arg != NULL && arg->Typ() == boxID)
+    {
+        box *B = (box*) arg->Data();
+        singularEndpoint e(B->R->cf);
         result->rtyp = NUMBER_CMD;
-        result->data = (void*) nSub(I->upper, I->lower);
+        result->data = (void*) ivcore::boxWidth(e, *B, B->R->N);
         arg->CleanUp();
         return FALSE;
     }
 
-    Werror("syntax: length(<interval>)");
+    Werror("syntax: length(<interval>) or length(<box>)");
     return TRUE;
 }
 
-// interval -> interval procedures
+// interval -> interval procedures, all arithmetic is done by intervalCore.h
+// in the coefficient domain of the interval, not of currRing
 
-interval* intervalScalarMultiply(number a, interval *I)
+static interval* wrap(ivcore::Interval<singularEndpoint> I, ring R)
 {
-    number lo, up;
-    if (nGreaterZero(a))
-    {
-        lo = nMult(a, I->lower);
-        up = nMult(a, I->upper);
-    }
-    else
-    {
-        lo = nMult(a, I->upper);
-        up = nMult(a, I->lower);
-    }
-
-    nNormalize(lo);
-    nNormalize(up);
+    return new interval(I.lower, I.upper, R);
+}
 
-    return new interval(lo, up);
+interval* intervalScalarMultiply(number a, interval *I)
+{
+    singularEndpoint e(I->R->cf);
+    return wrap(ivcore::scalarMul(e, a, *I), I->R);
 }
 
 interval* intervalMultiply(interval *I, interval *J)
 {
-    number lo, up;
-    number nums[4];
-    nums[0] = nMult(I->lower, J->lower);
-    nums[1] = nMult(I->lower, J->upper);
-    nums[2] = nMult(I->upper, J->lower);
-    nums[3] = nMult(I->upper, J->upper);
-
-    int i, imax = 0, imin = 0;
-    for (i = 1; i < 4; i++)
-    {
-        if (nGreater(nums[i], nums[imax]))
-        {
-            imax = i;
-        }
-        if (nGreater(nums[imin], nums[i]))
-        {
-            imin = i;
-        }
-    }
-
-    lo = nCopy(nums[imin]);
-    up = nCopy(nums[imax]);
-
-    // delete products
-    for (i = 0; i < 4; i++)
-    {
-        nDelete(&nums[i]);
-    }
-
-    nNormalize(lo);
-    nNormalize(up);
-
-    return new interval(lo, up);
+    ivCounters.multiplications++;
+    singularEndpoint e(I->R->cf);
+    return wrap(ivcore::mul(e, *I, *J), I->R);
 }
 
 interval* intervalAdd(interval *I, interval *J)
 {
-    number lo = nAdd(I->lower, J->lower),
-           up = nAdd(I->upper, J->upper);
-
-    nNormalize(lo);
-    nNormalize(up);
-
-    return new interval(lo, up);
+    singularEndpoint e(I->R->cf);
+    return wrap(ivcore::add(e, *I, *J), I->R);
 }
 
 interval* intervalSubtract(interval *I, interval *J)
 {
-    number lo = nSub(I->lower, J->upper),
-           up = nSub(I->upper, J->lower);
-
-    nNormalize(lo);
-    nNormalize(up);
-
-    return new interval(lo, up);
+    singularEndpoint e(I->R->cf);
+    return wrap(ivcore::sub(e, *I, *J), I->R);
 }
 
 bool intervalEqual(interval *I, interval *J)
 {
-    return nEqual(I->lower, J->lower) && nEqual(I->upper, J->upper);
+    singularEndpoint e(I->R->cf);
+    return ivcore::equal(e, *I, *J);
 }
 
 // ckeck if zero is contained in an interval
 bool intervalContainsZero(interval *I)
 {
-    number n = nMult(I->lower, I->upper);
-    bool result = !nGreaterZero(n);
-    // delete helper number
-    nDelete(&n);
-
-    return result;
+    singularEndpoint e(I->R->cf);
+    return ivcore::containsZero(e, *I);
 }
 
 interval* intervalPower(interval *I, int p)
 {
-    if (p == 0)
-    {
-        return new interval(nInit(1));
-    }
-
-    // no initialisation required (?)
-    number lo, up;
-
-    nPower(I->lower, p, &lo);
-    nPower(I->upper, p, &up);
-
-    // should work now
-    if (p % 2 == 1)
-    {
-        return new interval(lo, up);
-    }
-    else
-    {
-        // perform pointer swap if necessary
-        number tmp;
-        if (nGreater(lo, up))
-        {
-            tmp = up;
-            up = lo;
-            lo = tmp;
-        }
-
-        if (intervalContainsZero(I))
-        {
-            nDelete(&lo);
-            lo = nInit(0);
-        }
-        return new interval(lo, up);
-    }
+    singularEndpoint e(I->R->cf);
+    return wrap(ivcore::pow(e, *I, p), I->R);
 }
 
 /*
@@ -976,14 +1009,15 @@ BOOLEAN box_OpM(int op, leftv result, leftv args)
                 return TRUE;
             }
             box *B = (box*) args->Data();
-            int i, n = B->R->N;
-            number lowerb[n], upperb[n];
+            const ring R = B->R;
+            singularEndpoint e(R->cf);
+            int i, n = R->N;
+            typedef ivcore::Interval<singularEndpoint> ival;
+            std::vector<ival> C(n), D(n);
 
-            // do not copy, use same pointers, copy at the end
             for (i = 0; i < n; i++)
             {
-                lowerb[i] = B->intervals[i]->lower;
-                upperb[i] = B->intervals[i]->upper;
+                C[i] = ivcore::copy(e, *B->intervals[i]);
             }
 
             args = args->next;
@@ -992,37 +1026,29 @@ BOOLEAN box_OpM(int op, leftv result, leftv args)
                 if (args->Typ() != boxID)
                 {
                     Werror("can only intersect boxes");
+                    for (i = 0; i < n; i++) { ivcore::release(e, C[i]); }
                     return TRUE;
                 }
 
                 B = (box*) args->Data();
-                for (i = 0; i < n; i++)
+                bool meet = ivcore::boxIntersect(e, C.data(), *B, n, D.data());
+                for (i = 0; i < n; i++) { ivcore::release(e, C[i]); }
+                if (!meet)
                 {
-                    if (nGreater(B->intervals[i]->lower, lowerb[i]))
-                    {
-                        lowerb[i] = B->intervals[i]->lower;
-                    }
-                    if (nGreater(upperb[i], B->intervals[i]->upper))
-                    {
-                        upperb[i] = B->intervals[i]->upper;
-                    }
-
-                    if (nGreater(lowerb[i], upperb[i]))
-                    {
-                        result->rtyp = INT_CMD;
-                        result->data = (void*) (-1);
-                        a->CleanUp();
-                        return FALSE;
-                    }
+                    result->rtyp = INT_CMD;
+                    result->data = (void*) (-1);
+                    a->CleanUp();
+                    return FALSE;
                 }
+                C.swap(D);
                 args = args->next;
             }
 
-            // now copy the numbers
+            // the box takes the numbers of C
             box *RES = new box();
             for (i = 0; i < n; i++)
             {
-                RES->setInterval(i, new interval(nCopy(lowerb[i]), nCopy(upperb[i])));
+                RES->setInterval(i, new interval(C[i].lower, C[i].upper, R));
             }
 
             result->rtyp = boxID;
@@ -1083,7 +1109,7 @@ BOOLEAN box_deserialize(blackbox**, void **d, si_link f)
     for (i = 1; i < N; i++)
     {
         l = f->m->Read(f);
-        B->setInterval(0, (interval*) l->CopyD());
+        B->setInterval(i, (interval*) l->CopyD());
         l->CleanUp();
     }
 
@@ -1091,6 +1117,24 @@ BOOLEAN box_deserialize(blackbox**, void **d, si_link f)
     return FALSE;
 }
 
+// boxInInterior(A, B): 1 if A is contained in the interior of B, else 0
+BOOLEAN boxInInterior(leftv result, leftv args)
+{
+    const short t[] = {2, (short) boxID, (short) boxID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+    box *A = (box*) args->Data();
+    box *B = (box*) args->next->Data();
+    singularEndpoint e(A->R->cf);
+
+    result->rtyp = INT_CMD;
+    result->data = (void*) (long) ivcore::boxIsInterior(e, *A, *B, A->R->N);
+    args->CleanUp();
+    return FALSE;
+}
+
 BOOLEAN boxSet(leftv result, leftv args)
 {
     assume(result->Typ() == boxID);
@@ -1139,63 +1183,2250 @@ BOOLEAN boxSet(leftv result, leftv args)
 }
 
 /*
- * POLY FUNCTIONS
+ * BOXLIST FUNCTIONS
+ *
+ * A boxlist holds the endpoints of the boxes of a frontier or result in one
+ * array, see boxlistData, so that bulk operations run without a box object
+ * per entry. Copies and assignments share the array, operations build new
+ * boxlists:
+ *
+ *      boxlist L = l;          l list of boxes
+ *      size(L), L[i], L[iv]    count, i-th box, boxlist of the entries iv
+ *      L + M, L + B            concatenation, appending a box
+ *      boxlistToList(L)        list of boxes
+ *      boxlistExclude(I, L)    boxes on which no generator is excluded
+ *      boxlistSplit(I, L)      halves of the boxes along a root-free plane
+ *                              across the longest edge, and the boxes for
+ *                              which no such plane was certified
+ *      evalIdealAtBoxes(I, L)  enclosures of all generators on all boxes
  */
 
-BOOLEAN evalPolyAtBox(leftv result, leftv args)
+void* boxlist_Init(blackbox*)
 {
-    assume(result->Typ() == intervalID);
+    return (void*) new boxlist(currRing);
+}
 
-    const short t[] = {2, POLY_CMD, (short) boxID};
-    if (!iiCheckTypes(args, t, 1))
+void* boxlist_Copy(blackbox*, void *d)
+{
+    return (void*) new boxlist((boxlist*) d);
+}
+
+void boxlist_Destroy(blackbox*, void *d)
+{
+    if (d != NULL)
+        delete (boxlist*) d;
+}
+
+char* boxlist_String(blackbox*, void *d)
+{
+    if (d == NULL)
     {
-        return TRUE;
+        return omStrDup("ooo");
     }
+    boxlist *L = (boxlist*) d;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "boxlist of %d boxes", L->size());
+    return omStrDup(buf);
+}
 
-    poly p = (poly) args->Data();
-    box *B = (box*) args->next->Data();
-    int i, pot, n = B->R->N;
+BOOLEAN boxlist_Assign(leftv result, leftv args)
+{
+    assume(result->Typ() == boxlistID);
+    boxlist *RES;
 
-    interval *tmp, *tmpPot, *tmpMonom, *RES = new interval();
+    /*
+     * Allow assignments of the form
+     *
+     *      L = M,
+     *      L = l,
+     *
+     * where L, M boxlists, l list of boxes
+     */
 
-    while(p != NULL)
+    if (args->Typ() == boxlistID)
     {
-        tmpMonom = new interval(nInit(1));
-
-        for (i = 1; i <= n; i++)
+        RES = new boxlist((boxlist*) args->Data());
+    }
+    else if (args->Typ() == LIST_CMD)
+    {
+        RES = new boxlist(currRing);
+        lists l = (lists) args->Data();
+        int i, m = lSize(l);
+        RES->d->ivs.reserve((size_t) (m + 1) * currRing->N);
+        for (i = 0; i <= m; i++)
         {
-            pot = pGetExp(p, i);
+            if (l->m[i].Typ() != boxID)
+            {
+                Werror("list contains non-boxes");
+                delete RES;
+                args->CleanUp();
+                return TRUE;
+            }
+            box *B = (box*) l->m[i].Data();
+            if (B->R != RES->R())
+            {
+                Werror("box of another ring");
+                delete RES;
+                args->CleanUp();
+                return TRUE;
+            }
+            RES->append(B);
+        }
+    }
+    else
+    {
+        Werror("Input not supported: first argument not boxlist or list");
+        return TRUE;
+    }
 
-            tmpPot = intervalPower(B->intervals[i-1], pot);
-            tmp = intervalMultiply(tmpMonom, tmpPot);
+    if (result != NULL && result->Data() != NULL)
+    {
+        delete (boxlist*) result->Data();
+    }
 
-            delete tmpMonom;
-            delete tmpPot;
+    if (result->rtyp == IDHDL)
+    {
+        IDDATA((idhdl)result->data) = (char*) RES;
+    }
+    else
+    {
+        result->rtyp = boxlistID;
+        result->data = (void*) RES;
+    }
+    args->CleanUp();
 
-            tmpMonom = tmp;
-        }
+    return FALSE;
+}
 
-        tmp = intervalScalarMultiply(p->coef, tmpMonom);
-        delete tmpMonom;
-        tmpMonom = tmp;
+BOOLEAN boxlist_Op1(int op, leftv result, leftv arg)
+{
+    if (op == COUNT_CMD)
+    {
+        boxlist *L = (boxlist*) arg->Data();
+        result->rtyp = INT_CMD;
+        result->data = (void*) (long) L->size();
+        arg->CleanUp();
+        return FALSE;
+    }
+    return blackboxDefaultOp1(op, result, arg);
+}
 
-        tmp = intervalAdd(RES, tmpMonom);
-        delete RES;
-        delete tmpMonom;
+BOOLEAN boxlist_Op2(int op, leftv result, leftv l1, leftv l2)
+{
+    if (l1 == NULL || l1->Typ() != boxlistID)
+    {
+        Werror("first argument is not boxlist");
+        return TRUE;
+    }
 
-        RES = tmp;
+    boxlist *L = (boxlist*) l1->Data();
+    int k = L->size();
 
-        p = p->next;
+    switch(op)
+    {
+        case '[':
+        {
+            if (l2 != NULL && l2->Typ() == INT_CMD)
+            {
+                int i = (int)(long) l2->Data();
+                if (i < 1 || i > k)
+                {
+                    Werror("index out of bounds");
+                    return TRUE;
+                }
+                result->rtyp = boxID;
+                result->data = (void*) L->get(i-1);
+            }
+            else if (l2 != NULL && l2->Typ() == INTVEC_CMD)
+            {
+                intvec *iv = (intvec*) l2->Data();
+                boxlist *RES = new boxlist(L->R());
+                RES->d->ivs.reserve((size_t) iv->length() * L->R()->N);
+                for (int j = 0; j < iv->length(); j++)
+                {
+                    int i = (*iv)[j];
+                    if (i < 1 || i > k)
+                    {
+                        Werror("index out of bounds");
+                        delete RES;
+                        return TRUE;
+                    }
+                    RES->append((*L)[i-1]);
+                }
+                result->rtyp = boxlistID;
+                result->data = (void*) RES;
+            }
+            else
+            {
+                Werror("second argument not int or intvec");
+                return TRUE;
+            }
+            l1->CleanUp();
+            l2->CleanUp();
+            return FALSE;
+        }
+        case '+':
+        {
+            boxlist *RES = new boxlist(L->R());
+            if (l2 != NULL && l2->Typ() == boxlistID)
+            {
+                boxlist *M = (boxlist*) l2->Data();
+                if (M->R() != L->R())
+                {
+                    Werror("boxlists of different rings");
+                    delete RES;
+                    return TRUE;
+                }
+                RES->d->ivs.reserve(L->d->ivs.size() + M->d->ivs.size());
+                for (int j = 0; j < k; j++)
+                {
+                    RES->append((*L)[j]);
+                }
+                for (int j = 0; j < M->size(); j++)
+                {
+                    RES->append((*M)[j]);
+                }
+            }
+            else if (l2 != NULL && l2->Typ() == boxID)
+            {
+                box *B = (box*) l2->Data();
+                if (B->R != L->R())
+                {
+                    Werror("box of another ring");
+                    delete RES;
+                    return TRUE;
+                }
+                RES->d->ivs.reserve(L->d->ivs.size() + L->R()->N);
+                for (int j = 0; j < k; j++)
+                {
+                    RES->append((*L)[j]);
+                }
+                RES->append(B);
+            }
+            else
+            {
+                Werror("second argument not boxlist or box");
+                delete RES;
+                return TRUE;
+            }
+            result->rtyp = boxlistID;
+            result->data = (void*) RES;
+            l1->CleanUp();
+            l2->CleanUp();
+            return FALSE;
+        }
+        default:
+            return blackboxDefaultOp2(op, result, l1, l2);
     }
+}
 
-    if (result->Data() != NULL)
+BOOLEAN boxlist_serialize(blackbox*, void *d, si_link f)
+{
+    /*
+     * Format: "boxlist" setring k lower upper .. lower upper
+     *
+     * with the bounds of the k boxes one after the other
+     */
+    boxlist *L = (boxlist*) d;
+    sleftv l, k, n;
+    memset(&l, 0, sizeof(l));
+    memset(&k, 0, sizeof(k));
+    memset(&n, 0, sizeof(n));
+
+    l.rtyp = STRING_CMD;
+    l.data = (void*) "boxlist";
+    f->m->Write(f, &l);
+
+    f->m->SetRing(f, L->R(), TRUE);
+
+    k.rtyp = INT_CMD;
+    k.data = (void*) (long) L->size();
+    f->m->Write(f, &k);
+
+    n.rtyp = NUMBER_CMD;
+    for (const boxlistInterval &I : L->d->ivs)
     {
-        delete (box*) result->Data();
+        n.data = (void*) I.lower;
+        f->m->Write(f, &n);
+        n.data = (void*) I.upper;
+        f->m->Write(f, &n);
     }
 
-    result->rtyp = intervalID;
-    result->data = (void*) RES;
-    args->CleanUp();
+    if (currRing != L->R())
+        f->m->SetRing(f, currRing, FALSE);
+
+    return FALSE;
+}
+
+BOOLEAN boxlist_deserialize(blackbox**, void **d, si_link f)
+{
+    // the first read sets the ring
+    leftv l = f->m->Read(f);
+    int k = (int)(long) l->Data();
+    l->CleanUp();
+
+    boxlist *L = new boxlist(currRing);
+    size_t j, m = (size_t) k * currRing->N;
+    L->d->ivs.reserve(m);
+    for (j = 0; j < m; j++)
+    {
+        l = f->m->Read(f);
+        number lo = (number) l->CopyD();
+        l->CleanUp();
+        l = f->m->Read(f);
+        number up = (number) l->CopyD();
+        l->CleanUp();
+        L->d->ivs.push_back(ivcore::make<singularEndpoint>(lo, up));
+    }
+
+    *d = (void*) L;
+    return FALSE;
+}
+
+BOOLEAN boxlistToList(leftv result, leftv args)
+{
+    const short t[] = {1, (short) boxlistID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    boxlist *L = (boxlist*) args->Data();
+    lists RES = (lists) omAllocBin(slists_bin);
+    RES->Init(L->size());
+    for (int j = 0; j < L->size(); j++)
+    {
+        RES->m[j].rtyp = boxID;
+        RES->m[j].data = (void*) L->get(j);
+    }
+
+    result->rtyp = LIST_CMD;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+// true if the enclosure of some generator of I over B does not contain zero,
+// B the N intervals of a box of a boxlist or a face of one
+static bool boxExcluded(ideal I, const boxlistInterval *B, ring R)
+{
+    singularEndpoint e(R->cf);
+    for (int k = 0; k < IDELEMS(I); k++)
+    {
+        if (I->m[k] == NULL)
+        {
+            continue;
+        }
+        ivCounters.evaluations++;
+        boxlistInterval v = ivcore::evalPoly(e, B, R->N,
+            polyTerms(I->m[k], R));
+        bool excluded = !ivcore::containsZero(e, v);
+        ivcore::release(e, v);
+        if (excluded)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// boxlistExclude(I, L): boxlist of the boxes of L not excluded by evaluation
+BOOLEAN boxlistExclude(leftv result, leftv args)
+{
+    const short t[] = {2, IDEAL_CMD, (short) boxlistID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    ideal I = (ideal) args->Data();
+    boxlist *L = (boxlist*) args->next->Data();
+
+    boxlist *RES = new boxlist(L->R());
+    for (int j = 0; j < L->size(); j++)
+    {
+        if (!boxExcluded(I, (*L)[j], L->R()))
+        {
+            RES->append((*L)[j]);
+        }
+    }
+
+    result->rtyp = boxlistID;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+// boxlistSplit(I, L): list(H, U) of boxlists, H holds both halves of every
+// box of L which is cut across its longest edge by a plane on which some
+// generator of I is excluded by evaluation, so no root of I lies on the
+// common face; as in splitPlane the midpoint is tried first and the ratio is
+// decreased by 15/16 down to 1/4. U holds the boxes for which no plane was
+// certified, they are left to splitBox.
+BOOLEAN boxlistSplit(leftv result, leftv args)
+{
+    const short t[] = {2, IDEAL_CMD, (short) boxlistID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    ideal I = (ideal) args->Data();
+    boxlist *L = (boxlist*) args->next->Data();
+    const coeffs cf = L->R()->cf;
+    int N = L->R()->N;
+
+    boxlist *H = new boxlist(L->R()), *U = new boxlist(L->R());
+    H->d->ivs.reserve(2 * L->d->ivs.size());
+
+    number one = n_Init(1, cf), two = n_Init(2, cf), four = n_Init(4, cf);
+    number half = n_Div(one, two, cf), quarter = n_Div(one, four, cf);
+    number n15 = n_Init(15, cf), n16 = n_Init(16, cf);
+    number shrink = n_Div(n15, n16, cf);
+
+    // working copy of a box, shares the endpoints of L except coordinate m
+    std::vector<boxlistInterval> F(N);
+    for (int j = 0; j < L->size(); j++)
+    {
+        const boxlistInterval *B = (*L)[j];
+        std::copy(B, B + N, F.begin());
+
+        // longest edge
+        int i, m = 0;
+        number w, wm = n_Sub(B[0].upper, B[0].lower, cf);
+        for (i = 1; i < N; i++)
+        {
+            w = n_Sub(B[i].upper, B[i].lower, cf);
+            if (n_Greater(w, wm, cf))
+            {
+                n_Delete(&wm, cf);
+                wm = w;
+                m = i;
+            }
+            else
+            {
+                n_Delete(&w, cf);
+            }
+        }
+
+        // plane var(m) == lower + ratio * width
+        number ratio = n_Copy(half, cf), c = NULL, tmp;
+        bool found = false;
+        while (!n_Greater(quarter, ratio, cf))
+        {
+            tmp = n_Mult(ratio, wm, cf);
+            c = n_Add(B[m].lower, tmp, cf);
+            n_Normalize(c, cf);
+            n_Delete(&tmp, cf);
+
+            F[m] = ivcore::make<singularEndpoint>(c, c);
+            if (boxExcluded(I, F.data(), L->R()))
+            {
+                found = true;
+                break;
+            }
+            n_Delete(&c, cf);
+
+            tmp = n_Mult(ratio, shrink, cf);
+            n_Normalize(tmp, cf);
+            n_Delete(&ratio, cf);
+            ratio = tmp;
+        }
+        n_Delete(&ratio, cf);
+        n_Delete(&wm, cf);
+
+        if (found)
+        {
+            // append copies the endpoints
+            F[m] = ivcore::make<singularEndpoint>(B[m].lower, c);
+            H->append(F.data());
+            F[m] = ivcore::make<singularEndpoint>(c, B[m].upper);
+            H->append(F.data());
+            n_Delete(&c, cf);
+        }
+        else
+        {
+            U->append(B);
+        }
+    }
+    n_Delete(&one, cf);
+    n_Delete(&two, cf);
+    n_Delete(&four, cf);
+    n_Delete(&half, cf);
+    n_Delete(&quarter, cf);
+    n_Delete(&n15, cf);
+    n_Delete(&n16, cf);
+    n_Delete(&shrink, cf);
+
+    lists RES = (lists) omAllocBin(slists_bin);
+    RES->Init(2);
+    RES->m[0].rtyp = boxlistID;
+    RES->m[0].data = (void*) H;
+    RES->m[1].rtyp = boxlistID;
+    RES->m[1].data = (void*) U;
+
+    result->rtyp = LIST_CMD;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+// evalIdealAtBoxes(I, L): list whose j-th entry is the list of enclosures of
+// the generators of I over the j-th box of L
+BOOLEAN evalIdealAtBoxes(leftv result, leftv args)
+{
+    const short t[] = {2, IDEAL_CMD, (short) boxlistID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    ideal I = (ideal) args->Data();
+    boxlist *L = (boxlist*) args->next->Data();
+    ring R = L->R();
+    singularEndpoint e(R->cf);
+    int j, k, m = IDELEMS(I);
+
+    lists RES = (lists) omAllocBin(slists_bin);
+    RES->Init(L->size());
+    for (j = 0; j < L->size(); j++)
+    {
+        lists E = (lists) omAllocBin(slists_bin);
+        E->Init(m);
+        for (k = 0; k < m; k++)
+        {
+            E->m[k].rtyp = intervalID;
+            if (I->m[k] == NULL)
+            {
+                E->m[k].data = (void*) new interval(n_Init(0, R->cf),
+                    n_Init(0, R->cf), R);
+            }
+            else
+            {
+                ivCounters.evaluations++;
+                E->m[k].data = (void*) wrap(ivcore::evalPoly(e, (*L)[j],
+                    R->N, polyTerms(I->m[k], R)), R);
+            }
+        }
+        RES->m[j].rtyp = LIST_CMD;
+        RES->m[j].data = (void*) E;
+    }
+
+    result->rtyp = LIST_CMD;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+/*
+ * MATRIX FUNCTIONS
+ *
+ * Products of interval matrices, given as lists of rows of intervals like
+ * the rows of an ivmat. Over the rationals the product is enclosed in
+ * midpoint-radius form with floating-point matrix products and directed
+ * rounding (ivcore::midradMatMul); the entries are rounded outward to
+ * doubles first and the result endpoints are converted back exactly. When
+ * the operands are too narrow for doubles, the product is computed exactly.
+ */
+
+// a as double rounded in direction dir, false if out of range
+bool numberToDoubleRounded(number a, const coeffs cf,
+    ivcore::rounding dir, double &d)
+{
+    number num = n_GetNumerator(a, cf),
+           den = n_GetDenom(a, cf);
+    mpq_t q, r;
+    mpq_init(q);
+    mpq_init(r);
+    n_MPZ(mpq_numref(q), num, cf);
+    n_MPZ(mpq_denref(q), den, cf);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+
+    bool ok = mpz_sizeinbase(mpq_numref(q), 2)
+              < mpz_sizeinbase(mpq_denref(q), 2) + 1000;
+    if (ok)
+    {
+        // truncates, so at most one step away from the wanted direction
+        d = mpq_get_d(q);
+        mpq_set_d(r, d);
+        int c = mpq_cmp(r, q);
+        if (dir == ivcore::down && c > 0) { d = std::nextafter(d, -HUGE_VAL); }
+        if (dir == ivcore::up && c < 0) { d = std::nextafter(d, HUGE_VAL); }
+        ok = std::isfinite(d);
+    }
+
+    mpq_clear(q);
+    mpq_clear(r);
+    return ok;
+}
+
+// the double d as exact number of cf
+number doubleToNumber(double d, const coeffs cf)
+{
+    mpq_t x;
+    mpq_init(x);
+    mpq_set_d(x, d);
+
+    number num = n_InitMPZ(mpq_numref(x), cf),
+           den = n_InitMPZ(mpq_denref(x), cf);
+    number r = n_Div(num, den, cf);
+    n_Normalize(r, cf);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+    mpq_clear(x);
+    return r;
+}
+
+// endpoints of the k intervals M as doubles, rounded outward
+static bool intervalsToDoubles(interval* const *M, int k, const coeffs cf,
+    std::vector<double> &lo, std::vector<double> &up)
+{
+    lo.resize(k);
+    up.resize(k);
+    for (int i = 0; i < k; i++)
+    {
+        if (!numberToDoubleRounded(M[i]->lower, cf, ivcore::down, lo[i])
+            || !numberToDoubleRounded(M[i]->upper, cf, ivcore::up, up[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// C = A B for the m x p matrix A and the p x n matrix B, row major
+static void intervalMatMul(interval* const *A, interval* const *B, int m,
+    int p, int n, ring R, interval **C)
+{
+    const coeffs cf = R->cf;
+    int i, j, k;
+
+    if (nCoeff_is_Q(cf))
+    {
+        std::vector<double> Alo, Aup, Blo, Bup, Clo(m*n), Cup(m*n);
+        if (intervalsToDoubles(A, m*p, cf, Alo, Aup)
+            && intervalsToDoubles(B, p*n, cf, Blo, Bup)
+            && ivcore::midradMatMul(Alo.data(), Aup.data(), Blo.data(),
+                   Bup.data(), m, p, n, Clo.data(), Cup.data()))
+        {
+            for (i = 0; i < m*n; i++)
+            {
+                C[i] = new interval(doubleToNumber(Clo[i], cf),
+                    doubleToNumber(Cup[i], cf), R);
+            }
+            return;
+        }
+    }
+
+    interval *prod, *sum;
+    for (i = 0; i < m; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            sum = new interval(n_Init(0, cf), n_Init(0, cf), R);
+            for (k = 0; k < p; k++)
+            {
+                prod = intervalMultiply(A[i*p + k], B[k*n + j]);
+                interval *tmp = intervalAdd(sum, prod);
+                delete prod;
+                delete sum;
+                sum = tmp;
+            }
+            C[i*n + j] = sum;
+        }
+    }
+}
+
+// entries of the list of rows L as row major m x n matrix, false on error
+static bool rowsToMatrix(lists L, int &m, int &n, std::vector<interval*> &M)
+{
+    m = lSize(L) + 1;
+    n = 0;
+    M.clear();
+    for (int i = 0; i < m; i++)
+    {
+        if (L->m[i].Typ() != LIST_CMD)
+        {
+            Werror("matrix rows must be lists");
+            return false;
+        }
+        lists row = (lists) L->m[i].Data();
+        if (i == 0)
+        {
+            n = lSize(row) + 1;
+        }
+        else if (lSize(row) + 1 != n)
+        {
+            Werror("matrix rows of different length");
+            return false;
+        }
+        for (int j = 0; j < n; j++)
+        {
+            if (row->m[j].Typ() != intervalID)
+            {
+                Werror("matrix entries must be intervals");
+                return false;
+            }
+            M.push_back((interval*) row->m[j].Data());
+        }
+    }
+    if (m == 0 || n == 0)
+    {
+        Werror("empty matrix");
+        return false;
+    }
+    return true;
+}
+
+// ivmatProduct(A, B): rows of the product of the matrices with rows A and B
+BOOLEAN ivmatProduct(leftv result, leftv args)
+{
+    const short t[] = {2, LIST_CMD, LIST_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    int m, p, q, n;
+    std::vector<interval*> A, B;
+    if (!rowsToMatrix((lists) args->Data(), m, p, A)
+        || !rowsToMatrix((lists) args->next->Data(), q, n, B))
+    {
+        return TRUE;
+    }
+    if (p != q)
+    {
+        Werror("Matrices have wrong dimensions!");
+        return TRUE;
+    }
+
+    std::vector<interval*> C(m*n);
+    intervalMatMul(A.data(), B.data(), m, p, n, currRing, C.data());
+
+    lists RES = (lists) omAllocBin(slists_bin);
+    RES->Init(m);
+    for (int i = 0; i < m; i++)
+    {
+        lists row = (lists) omAllocBin(slists_bin);
+        row->Init(n);
+        for (int j = 0; j < n; j++)
+        {
+            row->m[j].rtyp = intervalID;
+            row->m[j].data = (void*) C[i*n + j];
+        }
+        RES->m[i].rtyp = LIST_CMD;
+        RES->m[i].data = (void*) row;
+    }
+
+    result->rtyp = LIST_CMD;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+// ivmatApply(A, B): box A B for the N x N matrix with rows A, N = nvars
+BOOLEAN ivmatApply(leftv result, leftv args)
+{
+    const short t[] = {2, LIST_CMD, (short) boxID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    box *B = (box*) args->next->Data();
+    int m, n, N = B->R->N;
+    std::vector<interval*> A;
+    if (!rowsToMatrix((lists) args->Data(), m, n, A))
+    {
+        return TRUE;
+    }
+    if (m != N || n != N)
+    {
+        Werror("Matrix has wrong dimensions");
+        return TRUE;
+    }
+
+    std::vector<interval*> C(N);
+    intervalMatMul(A.data(), B->intervals, N, N, 1, B->R, C.data());
+
+    box *RES = new box();
+    for (int i = 0; i < N; i++)
+    {
+        RES->setInterval(i, C[i]);
+    }
+
+    result->rtyp = boxID;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+/*
+ * POLY FUNCTIONS
+ */
+
+// interval enclosure of p over B, evaluated monomial by monomial
+interval* intervalEvalPoly(poly p, box *B)
+{
+    ivCounters.evaluations++;
+    singularEndpoint e(B->R->cf);
+    return wrap(ivcore::evalPoly(e, *B, B->R->N, polyTerms(p, B->R)), B->R);
+}
+
+BOOLEAN evalPolyAtBox(leftv result, leftv args)
+{
+    assume(result->Typ() == intervalID);
+
+    const short t[] = {2, POLY_CMD, (short) boxID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    poly p = (poly) args->Data();
+    box *B = (box*) args->next->Data();
+
+    interval *RES = intervalEvalPoly(p, B);
+
+    if (result->Data() != NULL)
+    {
+        delete (box*) result->Data();
+    }
+
+    result->rtyp = intervalID;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+// faceExclusion(I, B, todo): intvec of length 2N, entry 2i-1 (2i) is 1 if the
+// enclosure of some generator of I over the lower (upper) face of B[i] does
+// not contain zero, faces with todo entry 0 are skipped and stay 0; the faces
+// are evaluated one after the other, numbers and omalloc are not thread-safe,
+// the single call only saves the interpreter overhead per face
+BOOLEAN faceExclusion(leftv result, leftv args)
+{
+    const short t[] = {3, IDEAL_CMD, (short) boxID, INTVEC_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    ideal I = (ideal) args->Data();
+    box *B = (box*) args->next->Data();
+    intvec *todo = (intvec*) args->next->next->Data();
+    const coeffs cf = B->R->cf;
+    int n = B->R->N;
+
+    if (todo->length() != 2*n)
+    {
+        Werror("third argument must have length 2*nvars");
+        return TRUE;
+    }
+
+    intvec *RES = new intvec(2*n);
+
+    // one working copy of B, only the face coordinate is replaced
+    box F(B);
+    int i, j, k;
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            if ((*todo)[2*i+j] == 0)
+            {
+                continue;
+            }
+
+            number c = j == 0 ? B->intervals[i]->lower
+                              : B->intervals[i]->upper;
+            F.setInterval(i, new interval(n_Copy(c, cf), n_Copy(c, cf), B->R));
+
+            for (k = 0; k < IDELEMS(I); k++)
+            {
+                if (I->m[k] == NULL)
+                {
+                    continue;
+                }
+                interval *v = intervalEvalPoly(I->m[k], &F);
+                bool excluded = !intervalContainsZero(v);
+                delete v;
+                if (excluded)
+                {
+                    (*RES)[2*i+j] = 1;
+                    break;
+                }
+            }
+        }
+        F.setInterval(i, new interval(B->intervals[i]));
+    }
+
+    result->rtyp = INTVEC_CMD;
+    result->data = (void*) RES;
+    args->CleanUp();
+    return FALSE;
+}
+
+/*
+ * STATISTICS
+ */
+
+// counters are long, intvec entries int: saturate instead of wrapping
+static int clampCounter(long a)
+{
+    return a > INT_MAX ? INT_MAX : (int) a;
+}
+
+// returns intvec of kernel counters: evaluations, multiplications, boxes,
+// counted since the last intervalStatsClear()
+BOOLEAN intervalStats(leftv result, leftv args)
+{
+    if (args != NULL)
+    {
+        Werror("syntax: intervalStats()");
+        return TRUE;
+    }
+
+    intvec *iv = new intvec(3);
+    (*iv)[0] = clampCounter(ivCounters.evaluations);
+    (*iv)[1] = clampCounter(ivCounters.multiplications);
+    (*iv)[2] = clampCounter(ivCounters.boxes);
+
+    result->rtyp = INTVEC_CMD;
+    result->data = (void*) iv;
+    return FALSE;
+}
+
+BOOLEAN intervalStatsClear(leftv result, leftv args)
+{
+    if (args != NULL)
+    {
+        Werror("syntax: intervalStatsClear()");
+        return TRUE;
+    }
+
+    ivCounters.evaluations = 0;
+    ivCounters.multiplications = 0;
+    ivCounters.boxes = 0;
+
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+/*
+ * TRACING
+ */
+
+// convert rational number to nearest double, only used for reporting
+double numberToDouble(number a, coeffs cf)
+{
+    number num = n_GetNumerator(a, cf),
+           den = n_GetDenom(a, cf);
+    mpz_t z, d;
+    mpz_init(z);
+    mpz_init(d);
+    n_MPZ(z, num, cf);
+    n_MPZ(d, den, cf);
+
+    mpq_t q;
+    mpq_init(q);
+    mpq_set_num(q, z);
+    mpq_set_den(q, d);
+    double result = mpq_get_d(q);
+
+    mpq_clear(q);
+    mpz_clear(z);
+    mpz_clear(d);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+
+    return result;
+}
+
+static FILE *traceFile = NULL;
+static bool traceJSON = false;
+static long traceCount = 0;
+static std::chrono::steady_clock::time_point traceT0;
+
+/*
+ * Write subdivision tree events to a file. If the file name ends in ".json",
+ * the Trace Event Format of chrome://tracing is used (one instant event per
+ * record, the depth as thread id), otherwise CSV with header
+ *      ts_us,event,id,parent,depth,width
+ */
+BOOLEAN traceStart(leftv result, leftv args)
+{
+    const short t[] = {1, STRING_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    const char *name = (const char*) args->Data();
+
+    if (traceFile != NULL)
+    {
+        fclose(traceFile);
+    }
+
+    traceFile = fopen(name, "w");
+    if (traceFile == NULL)
+    {
+        Werror("cannot open trace file %s", name);
+        return TRUE;
+    }
+
+    size_t len = strlen(name);
+    traceJSON = len >= 5 && strcmp(name + len - 5, ".json") == 0;
+    traceCount = 0;
+    traceT0 = std::chrono::steady_clock::now();
+
+    if (traceJSON)
+    {
+        fputs("[\n", traceFile);
+    }
+    else
+    {
+        fputs("ts_us,event,id,parent,depth,width\n", traceFile);
+    }
+
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+BOOLEAN traceStop(leftv result, leftv)
+{
+    if (traceFile != NULL)
+    {
+        if (traceJSON)
+        {
+            fputs("\n]\n", traceFile);
+        }
+        fclose(traceFile);
+        traceFile = NULL;
+    }
+
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+BOOLEAN traceActive(leftv result, leftv)
+{
+    result->rtyp = INT_CMD;
+    result->data = (void*) (long) (traceFile != NULL);
+    return FALSE;
+}
+
+// traceBox(event, id, parent, depth, B), does nothing if no trace is open
+BOOLEAN traceBox(leftv result, leftv args)
+{
+    const short t[] = {5, STRING_CMD, INT_CMD, INT_CMD, INT_CMD, (short) boxID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    result->rtyp = NONE;
+    if (traceFile == NULL)
+    {
+        return FALSE;
+    }
+
+    leftv a = args;
+    const char *event = (const char*) a->Data(); a = a->next;
+    int id     = (int)(long) a->Data(); a = a->next;
+    int parent = (int)(long) a->Data(); a = a->next;
+    int depth  = (int)(long) a->Data(); a = a->next;
+    box *B = (box*) a->Data();
+
+    // width in the sense of lengthBox
+    int i, n = B->R->N;
+    double width = 0, w;
+    number l;
+    for (i = 0; i < n; i++)
+    {
+        l = n_Sub(B->intervals[i]->upper, B->intervals[i]->lower, B->R->cf);
+        w = numberToDouble(l, B->R->cf);
+        n_Delete(&l, B->R->cf);
+        if (w > width) { width = w; }
+    }
+
+    long ts = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - traceT0).count();
+
+    if (traceJSON)
+    {
+        fprintf(traceFile, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+            "\"ts\":%ld,\"pid\":1,\"tid\":%d,\"args\":{\"id\":%d,"
+            "\"parent\":%d,\"depth\":%d,\"width\":%.17g}}",
+            traceCount > 0 ? ",\n" : "", event, ts, depth, id, parent, depth,
+            width);
+    }
+    else
+    {
+        fprintf(traceFile, "%ld,%s,%d,%d,%d,%.17g\n", ts, event, id, parent,
+            depth, width);
+    }
+    traceCount++;
+
+    return FALSE;
+}
+
+/*
+ * HYPERPLANE CACHE
+ *
+ * Remembers whether V(I) meets the hyperplane var(i) == c, keyed by the
+ * ideal, i and c. Hashes only select candidates, entries are compared
+ * exactly, so a hash collision can never produce a wrong answer.
+ */
+
+static inline uint64_t fnvMix(uint64_t h, uint64_t v)
+{
+    return (h ^ v) * 1099511628211ULL;
+}
+
+static uint64_t mpzHash(uint64_t h, mpz_t z)
+{
+    h = fnvMix(h, (uint64_t) mpz_sgn(z));
+    size_t i, n = mpz_size(z);
+    for (i = 0; i < n; i++)
+    {
+        h = fnvMix(h, (uint64_t) mpz_getlimbn(z, i));
+    }
+    return h;
+}
+
+static uint64_t numberHash(uint64_t h, number a, coeffs cf)
+{
+    number num = n_GetNumerator(a, cf),
+           den = n_GetDenom(a, cf);
+    mpz_t z;
+    mpz_init(z);
+    n_MPZ(z, num, cf);
+    h = mpzHash(h, z);
+    n_MPZ(z, den, cf);
+    h = mpzHash(h, z);
+    mpz_clear(z);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+    return h;
+}
+
+static uint64_t idealHash(ideal I, ring R)
+{
+    uint64_t h = 14695981039346656037ULL;
+    int i, j;
+    poly p;
+    for (i = 0; i < IDELEMS(I); i++)
+    {
+        for (p = I->m[i]; p != NULL; pIter(p))
+        {
+            for (j = 1; j <= R->N; j++)
+            {
+                h = fnvMix(h, (uint64_t) p_GetExp(p, j, R));
+            }
+            h = numberHash(h, pGetCoeff(p), R->cf);
+        }
+        h = fnvMix(h, 0x9e3779b97f4a7c15ULL);
+    }
+    return h;
+}
+
+static bool idealEqual(ideal I, ideal J, ring R)
+{
+    if (IDELEMS(I) != IDELEMS(J)) { return false; }
+    for (int i = 0; i < IDELEMS(I); i++)
+    {
+        if (!p_EqualPolys(I->m[i], J->m[i], R)) { return false; }
+    }
+    return true;
+}
+
+struct hyperplaneEntry
+{
+    int ideal;      // index into hpIdeals
+    int var;
+    number value;
+    int empty;
+};
+
+#define HYPERPLANE_CACHE_MAX 65536
+
+static ring hpRing = NULL;
+static std::vector<ideal> hpIdeals;
+static std::vector<uint64_t> hpIdealHashes;
+static std::unordered_map<uint64_t, std::vector<hyperplaneEntry> > hpEntries;
+static long hpSize = 0, hpHits = 0, hpMisses = 0;
+
+static void hyperplaneCacheReset()
+{
+    if (hpRing != NULL)
+    {
+        for (auto &bucket : hpEntries)
+        {
+            for (hyperplaneEntry &e : bucket.second)
+            {
+                n_Delete(&e.value, hpRing->cf);
+            }
+        }
+        for (ideal I : hpIdeals)
+        {
+            id_Delete(&I, hpRing);
+        }
+        hpRing->ref--;
+    }
+    hpEntries.clear();
+    hpIdeals.clear();
+    hpIdealHashes.clear();
+    hpRing = NULL;
+    hpSize = 0;
+}
+
+// index of I in hpIdeals, stores a copy if insert is set, -1 if not found
+static int hyperplaneIdeal(ideal I, bool insert)
+{
+    if (hpRing != currRing)
+    {
+        hyperplaneCacheReset();
+        hpRing = currRing;
+        hpRing->ref++;
+    }
+
+    uint64_t h = idealHash(I, currRing);
+    for (size_t k = 0; k < hpIdeals.size(); k++)
+    {
+        if (hpIdealHashes[k] == h && idealEqual(hpIdeals[k], I, currRing))
+        {
+            return (int) k;
+        }
+    }
+    if (!insert) { return -1; }
+
+    hpIdeals.push_back(id_Copy(I, currRing));
+    hpIdealHashes.push_back(h);
+    return (int) hpIdeals.size() - 1;
+}
+
+static uint64_t hyperplaneKey(int k, int i, number c)
+{
+    return numberHash(fnvMix(fnvMix(14695981039346656037ULL, k), i), c,
+        currRing->cf);
+}
+
+// hyperplaneCacheGet(I, i, c): 1 if V(I) does not meet var(i) == c, 0 if it
+// does, -1 if unknown
+BOOLEAN hyperplaneCacheGet(leftv result, leftv args)
+{
+    const short t[] = {3, IDEAL_CMD, INT_CMD, NUMBER_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+    ideal I = (ideal) args->Data();
+    int i = (int)(long) args->next->Data();
+    number c = (number) args->next->next->Data();
+
+    long res = -1;
+    int k = hyperplaneIdeal(I, false);
+    if (k >= 0)
+    {
+        auto it = hpEntries.find(hyperplaneKey(k, i, c));
+        if (it != hpEntries.end())
+        {
+            for (hyperplaneEntry &e : it->second)
+            {
+                if (e.ideal == k && e.var == i
+                    && n_Equal(e.value, c, currRing->cf))
+                {
+                    res = e.empty;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (res < 0) { hpMisses++; }
+    else         { hpHits++; }
+
+    result->rtyp = INT_CMD;
+    result->data = (void*) res;
+    return FALSE;
+}
+
+// hyperplaneCachePut(I, i, c, empty)
+BOOLEAN hyperplaneCachePut(leftv result, leftv args)
+{
+    const short t[] = {4, IDEAL_CMD, INT_CMD, NUMBER_CMD, INT_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+    ideal I = (ideal) args->Data();
+    int i = (int)(long) args->next->Data();
+    number c = (number) args->next->next->Data();
+    int empty = (int)(long) args->next->next->next->Data();
+
+    // bounded, start over when full
+    if (hpSize >= HYPERPLANE_CACHE_MAX)
+    {
+        hyperplaneCacheReset();
+    }
+
+    int k = hyperplaneIdeal(I, true);
+    hyperplaneEntry e;
+    e.ideal = k;
+    e.var = i;
+    e.value = n_Copy(c, currRing->cf);
+    e.empty = empty;
+    hpEntries[hyperplaneKey(k, i, c)].push_back(e);
+    hpSize++;
+
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+BOOLEAN hyperplaneCacheClear(leftv result, leftv)
+{
+    hyperplaneCacheReset();
+    hpHits = 0;
+    hpMisses = 0;
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+// intvec of hits, misses and number of entries
+BOOLEAN hyperplaneCacheStats(leftv result, leftv)
+{
+    intvec *iv = new intvec(3);
+    (*iv)[0] = (int) hpHits;
+    (*iv)[1] = (int) hpMisses;
+    (*iv)[2] = (int) hpSize;
+
+    result->rtyp = INTVEC_CMD;
+    result->data = (void*) iv;
+    return FALSE;
+}
+
+/*
+ * ROOT INDEX
+ *
+ * Boxes known to contain exactly one root (uniqueness regions) in a k-d tree
+ * over the 2N-dimensional points (-lower, upper). A box B lies in a region R
+ * iff the point of R dominates the point of B, and B meets R iff the point
+ * of R dominates (-upper, lower) of B, so both queries are dominance
+ * queries. The tree works on doubles to prune, every hit is confirmed with
+ * exact comparisons.
+ */
+
+struct rootIndexNode
+{
+    std::vector<double> key, max;
+    box *region;
+    rootIndexNode *left, *right;
+};
+
+static ring riRing = NULL;
+static rootIndexNode *riRoot = NULL;
+static long riSize = 0, riDropped = 0, riDuplicates = 0;
+
+// relative slack for the double comparisons, exact checks decide
+#define ROOT_INDEX_SLACK 1e-12
+
+static void rootIndexFree(rootIndexNode *t)
+{
+    if (t == NULL)
+    {
+        return;
+    }
+    rootIndexFree(t->left);
+    rootIndexFree(t->right);
+    delete t->region;
+    delete t;
+}
+
+static void rootIndexReset()
+{
+    rootIndexFree(riRoot);
+    riRoot = NULL;
+    if (riRing != NULL)
+    {
+        riRing->ref--;
+    }
+    riRing = NULL;
+    riSize = 0;
+}
+
+static std::vector<double> rootIndexKey(box *B)
+{
+    int n = B->R->N, i;
+    std::vector<double> k(2*n);
+    for (i = 0; i < n; i++)
+    {
+        k[i] = -numberToDouble(B->intervals[i]->lower, B->R->cf);
+        k[n+i] = numberToDouble(B->intervals[i]->upper, B->R->cf);
+    }
+    return k;
+}
+
+static inline double slack(double a)
+{
+    return ROOT_INDEX_SLACK * (fabs(a) + 1.0);
+}
+
+// exact test whether B is contained in R
+static bool boxContained(box *B, box *R)
+{
+    const coeffs cf = R->R->cf;
+    for (int i = 0; i < R->R->N; i++)
+    {
+        if (n_Greater(R->intervals[i]->lower, B->intervals[i]->lower, cf)
+            || n_Greater(B->intervals[i]->upper, R->intervals[i]->upper, cf))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// exact test whether B and R intersect
+static bool boxMeets(box *B, box *R)
+{
+    const coeffs cf = R->R->cf;
+    for (int i = 0; i < R->R->N; i++)
+    {
+        if (n_Greater(R->intervals[i]->lower, B->intervals[i]->upper, cf)
+            || n_Greater(B->intervals[i]->lower, R->intervals[i]->upper, cf))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// query point of the regions meeting B, see above
+static std::vector<double> rootIndexMeetKey(box *B)
+{
+    std::vector<double> k = rootIndexKey(B);
+    size_t i, n = k.size() / 2;
+    for (i = 0; i < n; i++)
+    {
+        double lo = -k[i];
+        k[i] = -k[n+i];
+        k[n+i] = lo;
+    }
+    return k;
+}
+
+typedef bool (*regionTest)(box*, box*);
+
+// some region R of the subtree t with test(B, R), NULL if none
+static box* rootIndexFind(rootIndexNode *t, const std::vector<double> &q,
+    box *B, size_t depth, regionTest test = boxContained)
+{
+    while (t != NULL)
+    {
+        size_t i, d = q.size();
+        for (i = 0; i < d; i++)
+        {
+            if (t->max[i] < q[i] - slack(q[i]))
+            {
+                return NULL;
+            }
+        }
+        for (i = 0; i < d; i++)
+        {
+            if (t->key[i] < q[i] - slack(q[i]))
+            {
+                break;
+            }
+        }
+        if (i == d && test(B, t->region))
+        {
+            return t->region;
+        }
+
+        // keys in the left subtree are below the split value
+        size_t s = depth % d;
+        if (q[s] - slack(q[s]) <= t->key[s])
+        {
+            box *R = rootIndexFind(t->left, q, B, depth + 1, test);
+            if (R != NULL)
+            {
+                return R;
+            }
+        }
+        t = t->right;
+        depth++;
+    }
+    return NULL;
+}
+
+static void rootIndexAdd(box *region)
+{
+    rootIndexNode *node = new rootIndexNode;
+    node->key = rootIndexKey(region);
+    node->max = node->key;
+    node->region = new box(region);
+    node->left = node->right = NULL;
+
+    rootIndexNode **t = &riRoot;
+    size_t depth = 0, d = node->key.size(), i;
+    while (*t != NULL)
+    {
+        for (i = 0; i < d; i++)
+        {
+            (*t)->max[i] = std::max((*t)->max[i], node->key[i]);
+        }
+        size_t s = depth % d;
+        t = node->key[s] < (*t)->key[s] ? &(*t)->left : &(*t)->right;
+        depth++;
+    }
+    *t = node;
+    riSize++;
+}
+
+// the index holds boxes of one ring, start over when it changes
+static void rootIndexRing()
+{
+    if (riRing != currRing)
+    {
+        rootIndexReset();
+        riRing = currRing;
+        riRing->ref++;
+    }
+}
+
+// rootIndexContains(B): 1 if B lies in a known uniqueness region, i.e. its
+// only possible root has been found already
+BOOLEAN rootIndexContains(leftv result, leftv args)
+{
+    const short t[] = {1, (short) boxID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+    box *B = (box*) args->Data();
+    rootIndexRing();
+
+    long res = rootIndexFind(riRoot, rootIndexKey(B), B, 0) != NULL;
+    if (res)
+    {
+        riDropped++;
+    }
+
+    result->rtyp = INT_CMD;
+    result->data = (void*) res;
+    return FALSE;
+}
+
+/*
+ * rootIndexInsert(R, B[, force]): records the uniqueness region R of the
+ * root in B, B contained in R. Returns
+ *
+ *      0       if B lies in a known region, i.e. the root is known already,
+ *      1       if B meets no known region and R has been recorded,
+ *      K       a known region meeting B, if B is neither contained in nor
+ *              disjoint from the known regions: the caller has to contract
+ *              B further, regions hold one root each.
+ *
+ * With force != 0, R is recorded instead of returning K.
+ */
+BOOLEAN rootIndexInsert(leftv result, leftv args)
+{
+    const short t2[] = {2, (short) boxID, (short) boxID};
+    const short t3[] = {3, (short) boxID, (short) boxID, INT_CMD};
+    if (!iiCheckTypes(args, t2, 0) && !iiCheckTypes(args, t3, 1))
+    {
+        return TRUE;
+    }
+    box *R = (box*) args->Data();
+    box *B = (box*) args->next->Data();
+    bool force = args->next->next != NULL
+                 && (long) args->next->next->Data() != 0;
+    rootIndexRing();
+
+    if (rootIndexFind(riRoot, rootIndexKey(B), B, 0) != NULL)
+    {
+        riDuplicates++;
+        result->rtyp = INT_CMD;
+        result->data = (void*) 0;
+        return FALSE;
+    }
+
+    box *K = force ? NULL
+                   : rootIndexFind(riRoot, rootIndexMeetKey(B), B, 0,
+                         boxMeets);
+    if (K != NULL)
+    {
+        result->rtyp = boxID;
+        result->data = (void*) new box(K);
+        return FALSE;
+    }
+
+    rootIndexAdd(R);
+    result->rtyp = INT_CMD;
+    result->data = (void*) 1;
+    return FALSE;
+}
+
+BOOLEAN rootIndexClear(leftv result, leftv)
+{
+    rootIndexReset();
+    riDropped = 0;
+    riDuplicates = 0;
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+// intvec of regions, dropped boxes and rejected duplicate roots
+BOOLEAN rootIndexStats(leftv result, leftv)
+{
+    intvec *iv = new intvec(3);
+    (*iv)[0] = (int) riSize;
+    (*iv)[1] = (int) riDropped;
+    (*iv)[2] = (int) riDuplicates;
+
+    result->rtyp = INTVEC_CMD;
+    result->data = (void*) iv;
+    return FALSE;
+}
+
+/*
+ * REAL ROOT ISOLATION
+ */
+
+// dense univariate polynomial with integer coefficients, c[j] belongs to x^j
+struct zpoly
+{
+    int d;
+    mpz_t *c;
+
+    zpoly(int deg) : d(deg)
+    {
+        c = new mpz_t[d+1];
+        for (int j = 0; j <= d; j++)
+        {
+            mpz_init(c[j]);
+        }
+    }
+    zpoly(const zpoly &q) : d(q.d)
+    {
+        c = new mpz_t[d+1];
+        for (int j = 0; j <= d; j++)
+        {
+            mpz_init_set(c[j], q.c[j]);
+        }
+    }
+    ~zpoly()
+    {
+        for (int j = 0; j <= d; j++)
+        {
+            mpz_clear(c[j]);
+        }
+        delete[] c;
+    }
+    zpoly& operator=(const zpoly&) = delete;
+};
+
+// q(x) := q(x+1), classical O(d^2) Taylor shift
+static void taylorShift1(zpoly &q)
+{
+    for (int i = 0; i < q.d; i++)
+    {
+        for (int j = q.d - 1; j >= i; j--)
+        {
+            mpz_add(q.c[j], q.c[j], q.c[j+1]);
+        }
+    }
+}
+
+// q(x) := 2^d q(x/2), then divide out common powers of two
+static void homothety2(zpoly &q)
+{
+    int j;
+    for (j = 0; j < q.d; j++)
+    {
+        mpz_mul_2exp(q.c[j], q.c[j], q.d - j);
+    }
+
+    mp_bitcnt_t s = ~(mp_bitcnt_t) 0, t;
+    for (j = 0; j <= q.d; j++)
+    {
+        if (mpz_sgn(q.c[j]) != 0)
+        {
+            t = mpz_scan1(q.c[j], 0);
+            if (t < s) { s = t; }
+        }
+    }
+    if (s > 0 && s != ~(mp_bitcnt_t) 0)
+    {
+        for (j = 0; j <= q.d; j++)
+        {
+            mpz_tdiv_q_2exp(q.c[j], q.c[j], s);
+        }
+    }
+}
+
+// Descartes bound for the roots of q in (0,1): sign variations of
+// (x+1)^d q(1/(x+1)), capped at 2
+static int descartesBound(const zpoly &q)
+{
+    zpoly r(q.d);
+    int j;
+    for (j = 0; j <= q.d; j++)
+    {
+        mpz_set(r.c[j], q.c[q.d - j]);
+    }
+    taylorShift1(r);
+
+    int var = 0, last = 0, s;
+    for (j = 0; j <= r.d; j++)
+    {
+        s = mpz_sgn(r.c[j]);
+        if (s == 0) { continue; }
+        if (last != 0 && s != last)
+        {
+            if (++var == 2) { break; }
+        }
+        last = s;
+    }
+    return var;
+}
+
+// x as rational
+static void numberToMpq(mpq_t r, number x, const coeffs cf)
+{
+    number num = n_GetNumerator(x, cf), den = n_GetDenom(x, cf);
+    n_MPZ(mpq_numref(r), num, cf);
+    n_MPZ(mpq_denref(r), den, cf);
+    mpq_canonicalize(r);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+}
+
+// x as number of cf
+static number mpqToNumber(mpq_t x, const coeffs cf)
+{
+    number num = n_InitMPZ(mpq_numref(x), cf),
+           den = n_InitMPZ(mpq_denref(x), cf);
+    number r = n_Div(num, den, cf);
+    n_Normalize(r, cf);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+    return r;
+}
+
+// a + w * c / 2^k as number of cf
+static number dyadicPoint(mpq_t a, mpq_t w, mpz_t c, unsigned long k,
+    const coeffs cf)
+{
+    mpq_t x;
+    mpq_init(x);
+    mpq_set_z(x, c);
+    mpq_div_2exp(x, x, k);
+    mpq_mul(x, x, w);
+    mpq_add(x, x, a);
+
+    number r = mpqToNumber(x, cf);
+    mpq_clear(x);
+    return r;
+}
+
+// q(x) = p(a + w x) with the denominators cleared, pc[j] the rational
+// coefficient of x^j in p, j = 0..q.d
+static void shiftPoly(zpoly &q, mpq_t *pc, mpq_t a, mpq_t w)
+{
+    int i, j, d = q.d;
+    mpq_t *qc = new mpq_t[d+1];
+    mpq_t tmp;
+    mpq_init(tmp);
+    for (j = 0; j <= d; j++)
+    {
+        mpq_init(qc[j]);
+    }
+
+    // Horner's scheme, qc := qc * (a + w x) + pc[i]
+    for (i = d; i >= 0; i--)
+    {
+        for (j = d; j >= 1; j--)
+        {
+            mpq_mul(qc[j], qc[j], a);
+            mpq_mul(tmp, qc[j-1], w);
+            mpq_add(qc[j], qc[j], tmp);
+        }
+        mpq_mul(qc[0], qc[0], a);
+        mpq_add(qc[0], qc[0], pc[i]);
+    }
+
+    mpz_t z;
+    mpz_init_set_ui(z, 1);
+    for (j = 0; j <= d; j++)
+    {
+        mpz_lcm(z, z, mpq_denref(qc[j]));
+    }
+    for (j = 0; j <= d; j++)
+    {
+        mpz_divexact(q.c[j], z, mpq_denref(qc[j]));
+        mpz_mul(q.c[j], q.c[j], mpq_numref(qc[j]));
+        mpq_clear(qc[j]);
+    }
+    delete[] qc;
+    mpz_clear(z);
+    mpq_clear(tmp);
+}
+
+// true if p has no root in (x, x + h] (or [x + h, x) for h < 0), x a simple
+// root of p of degree d > 0
+static bool noRootNextTo(mpq_t *pc, int d, mpq_t x, mpq_t h)
+{
+    zpoly q(d);
+    shiftPoly(q, pc, x, h);
+
+    // q(0) == 0, the remaining roots of q are those of q / x
+    zpoly r(d - 1);
+    mpz_t s;
+    mpz_init(s);
+    for (int j = 0; j < d; j++)
+    {
+        mpz_set(r.c[j], q.c[j+1]);
+        mpz_add(s, s, r.c[j]);
+    }
+    bool free = mpz_sgn(s) != 0 && descartesBound(r) == 0;
+    mpz_clear(s);
+    return free;
+}
+
+struct rootIsolator
+{
+    mpq_t a, w;
+    ring R;
+    std::vector<interval*> roots;
+    std::vector<bool> exact;
+
+    void point(mpz_t c, unsigned long k)
+    {
+        number x = dyadicPoint(a, w, c, k, R->cf);
+        roots.push_back(new interval(x, n_Copy(x, R->cf), R));
+        exact.push_back(true);
+    }
+
+    // roots of q in the open interval (c/2^k, (c+1)/2^k), in ascending order
+    void isolate(const zpoly &q, mpz_t c, unsigned long k)
+    {
+        int var = descartesBound(q);
+        if (var == 0)
+        {
+            return;
+        }
+
+        // exactly one root, closed interval may not end in a further root
+        if (var == 1 && mpz_sgn(q.c[0]) != 0)
+        {
+            mpz_t s;
+            mpz_init(s);
+            for (int j = 0; j <= q.d; j++)
+            {
+                mpz_add(s, s, q.c[j]);
+            }
+            bool endRoot = mpz_sgn(s) == 0;
+            mpz_clear(s);
+
+            if (!endRoot)
+            {
+                mpz_t c1;
+                mpz_init(c1);
+                mpz_add_ui(c1, c, 1);
+                roots.push_back(new interval(dyadicPoint(a, w, c, k, R->cf),
+                    dyadicPoint(a, w, c1, k, R->cf), R));
+                exact.push_back(false);
+                mpz_clear(c1);
+                return;
+            }
+        }
+
+        // bisect, left half 2^d q(x/2), right half its shift by one
+        zpoly left(q);
+        homothety2(left);
+        zpoly right(left);
+        taylorShift1(right);
+
+        mpz_t cl, cm;
+        mpz_init(cl);
+        mpz_init(cm);
+        mpz_mul_2exp(cl, c, 1);
+        mpz_add_ui(cm, cl, 1);
+
+        isolate(left, cl, k + 1);
+        if (mpz_sgn(right.c[0]) == 0)
+        {
+            point(cm, k + 1);
+        }
+        isolate(right, cm, k + 1);
+
+        mpz_clear(cl);
+        mpz_clear(cm);
+    }
+};
+
+// isolateRealRoots(p, I): list of intervals in ascending order containing
+// all real roots of the squarefree univariate polynomial p in I, every one
+// exactly one root in its interior and none on its ends; an exact rational
+// root x is returned as [x - h, x + h], h a power of two such that this
+// contains no further root of p, meets no other interval and, unless x is
+// an end of I, lies in I
+BOOLEAN isolateRealRoots(leftv result, leftv args)
+{
+    const short t[] = {2, POLY_CMD, (short) intervalID};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    poly p = (poly) args->Data();
+    interval *I = (interval*) args->next->Data();
+    const ring R = currRing;
+    const coeffs cf = R->cf;
+
+    if (!nCoeff_is_Q(cf) || I->R->cf != cf)
+    {
+        Werror("isolateRealRoots: rational coefficients expected");
+        return TRUE;
+    }
+
+    // find the variable and the degree
+    int v = 0, d = 0, i, j;
+    poly m;
+    for (m = p; m != NULL; m = pNext(m))
+    {
+        for (i = 1; i <= R->N; i++)
+        {
+            if (p_GetExp(m, i, R) == 0) { continue; }
+            if (v != 0 && v != i)
+            {
+                Werror("isolateRealRoots: univariate polynomial expected");
+                return TRUE;
+            }
+            v = i;
+            d = si_max(d, (int) p_GetExp(m, i, R));
+        }
+    }
+
+    if (p == NULL)
+    {
+        Werror("isolateRealRoots: polynomial must not be zero");
+        return TRUE;
+    }
+
+    rootIsolator iso;
+    iso.R = R;
+    mpq_init(iso.a);
+    mpq_init(iso.w);
+
+    mpz_t z;
+    mpz_init(z);
+
+    numberToMpq(iso.a, I->lower, cf);
+    numberToMpq(iso.w, I->upper, cf);
+    mpq_sub(iso.w, iso.w, iso.a);
+
+    // rational coefficients of p
+    mpq_t *pc = new mpq_t[d+1];
+    for (j = 0; j <= d; j++)
+    {
+        mpq_init(pc[j]);
+    }
+    for (m = p; m != NULL; m = pNext(m))
+    {
+        j = v == 0 ? 0 : (int) p_GetExp(m, v, R);
+        numberToMpq(pc[j], pGetCoeff(m), cf);
+    }
+
+    // q(x) = p(a + w x), maps I to [0,1]
+    zpoly q(d);
+    shiftPoly(q, pc, iso.a, iso.w);
+
+    // roots at the end points, then the open interval
+    mpz_set_ui(z, 0);
+    if (mpz_sgn(q.c[0]) == 0)
+    {
+        iso.point(z, 0);
+    }
+    if (mpq_sgn(iso.w) != 0 && d > 0)
+    {
+        iso.isolate(q, z, 0);
+
+        mpz_t s;
+        mpz_init(s);
+        for (j = 0; j <= d; j++)
+        {
+            mpz_add(s, s, q.c[j]);
+        }
+        if (mpz_sgn(s) == 0)
+        {
+            mpz_set_ui(z, 1);
+            iso.point(z, 0);
+        }
+        mpz_clear(s);
+    }
+    mpz_clear(z);
+
+    /*
+     * Widen the exact roots, a box edge ending in a root can never be
+     * verified by the interval Newton step. h is the largest power of two
+     * not exceeding a quarter of the distance to the neighbours and the ends
+     * of I, halved until p has no further root in [x - h, x + h].
+     */
+    mpq_t x, g, h, y;
+    mpq_init(x);
+    mpq_init(g);
+    mpq_init(h);
+    mpq_init(y);
+    for (i = 0; i < (int) iso.roots.size(); i++)
+    {
+        if (!iso.exact[i])
+        {
+            continue;
+        }
+        numberToMpq(x, iso.roots[i]->lower, cf);
+
+        mpq_abs(g, iso.w);
+        if (mpq_sgn(g) == 0)
+        {
+            mpq_set_ui(g, 1, 1);
+        }
+        if (i > 0)
+        {
+            numberToMpq(y, iso.roots[i-1]->upper, cf);
+            mpq_sub(y, x, y);
+            if (mpq_cmp(y, g) < 0) { mpq_set(g, y); }
+        }
+        if (i + 1 < (int) iso.roots.size())
+        {
+            numberToMpq(y, iso.roots[i+1]->lower, cf);
+            mpq_sub(y, y, x);
+            if (mpq_cmp(y, g) < 0) { mpq_set(g, y); }
+        }
+        // ends of I, unless x is one of them
+        mpq_sub(y, x, iso.a);
+        if (mpq_sgn(y) > 0 && mpq_cmp(y, g) < 0) { mpq_set(g, y); }
+        mpq_add(y, iso.a, iso.w);
+        mpq_sub(y, y, x);
+        if (mpq_sgn(y) > 0 && mpq_cmp(y, g) < 0) { mpq_set(g, y); }
+        mpq_div_2exp(g, g, 2);
+
+        mpq_set_ui(h, 1, 1);
+        while (mpq_cmp(h, g) > 0)
+        {
+            mpq_div_2exp(h, h, 1);
+        }
+        mpq_mul_2exp(y, h, 1);
+        while (mpq_cmp(y, g) <= 0)
+        {
+            mpq_set(h, y);
+            mpq_mul_2exp(y, h, 1);
+        }
+
+        while (true)
+        {
+            mpq_neg(y, h);
+            if (noRootNextTo(pc, d, x, h) && noRootNextTo(pc, d, x, y))
+            {
+                break;
+            }
+            mpq_div_2exp(h, h, 1);
+        }
+
+        delete iso.roots[i];
+        mpq_sub(y, x, h);
+        number lo = mpqToNumber(y, cf);
+        mpq_add(y, x, h);
+        iso.roots[i] = new interval(lo, mpqToNumber(y, cf), R);
+    }
+    mpq_clear(x);
+    mpq_clear(g);
+    mpq_clear(h);
+    mpq_clear(y);
+
+    for (j = 0; j <= d; j++)
+    {
+        mpq_clear(pc[j]);
+    }
+    delete[] pc;
+    mpq_clear(iso.a);
+    mpq_clear(iso.w);
+
+    lists L = (lists) omAllocBin(slists_bin);
+    L->Init(iso.roots.size());
+    for (i = 0; i < (int) iso.roots.size(); i++)
+    {
+        L->m[i].rtyp = intervalID;
+        L->m[i].data = (void*) iso.roots[i];
+    }
+
+    result->rtyp = LIST_CMD;
+    result->data = (void*) L;
+    args->CleanUp();
+    return FALSE;
+}
+
+/*
+ * RESULT CACHE
+ *
+ * Files <dir>/<hash>.ssi written and read by rootIsolation.lib, named by the
+ * 64 bit FNV-1a hash of a canonical key string. The files contain the key as
+ * well, so the reader detects hash collisions. Reading a file touches it, and
+ * once the directory holds more than the size limit, the files with the
+ * oldest modification time are removed.
+ */
+
+static std::string cacheDir;
+static long cacheMaxBytes = 0;
+
+// rootCacheOpen(dir, maxKB), creates dir if it does not exist
+BOOLEAN rootCacheOpen(leftv result, leftv args)
+{
+    const short t[] = {2, STRING_CMD, INT_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    const char *dir = (const char*) args->Data();
+    long maxKB = (long) args->next->Data();
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST)
+    {
+        Werror("cannot create cache directory %s", dir);
+        return TRUE;
+    }
+
+    cacheDir = dir;
+    cacheMaxBytes = maxKB * 1024;
+
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+BOOLEAN rootCacheClose(leftv result, leftv)
+{
+    cacheDir.clear();
+    cacheMaxBytes = 0;
+    result->rtyp = NONE;
+    return FALSE;
+}
+
+// rootCacheFile(key): file for key, "" if no cache is open
+BOOLEAN rootCacheFile(leftv result, leftv args)
+{
+    const short t[] = {1, STRING_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    std::string name;
+    if (!cacheDir.empty())
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (const char *c = (const char*) args->Data(); *c != '\0'; c++)
+        {
+            h = fnvMix(h, (unsigned char) *c);
+        }
+
+        char buf[32];
+        snprintf(buf, sizeof(buf), "/%016llx.ssi", (unsigned long long) h);
+        name = cacheDir + buf;
+
+        // mark as recently used, fails if there is no such file
+        utime(name.c_str(), NULL);
+    }
+
+    result->rtyp = STRING_CMD;
+    result->data = (void*) omStrDup(name.c_str());
+    return FALSE;
+}
+
+struct cacheEntry
+{
+    std::string path;
+    time_t mtime;
+    long size;
+};
+
+// rootCacheCommit(tmp, file): renames the written file tmp to file, then
+// evicts the least recently used files, returns the number removed
+BOOLEAN rootCacheCommit(leftv result, leftv args)
+{
+    const short t[] = {2, STRING_CMD, STRING_CMD};
+    if (!iiCheckTypes(args, t, 1))
+    {
+        return TRUE;
+    }
+
+    const char *tmp = (const char*) args->Data(),
+               *file = (const char*) args->next->Data();
+
+    // readers see either no file or a complete one
+    if (rename(tmp, file) != 0)
+    {
+        Werror("cannot move %s to %s", tmp, file);
+        return TRUE;
+    }
+
+    long removed = 0;
+    DIR *dir = cacheDir.empty() ? NULL : opendir(cacheDir.c_str());
+    if (dir != NULL)
+    {
+        std::vector<cacheEntry> files;
+        long total = 0;
+        struct dirent *e;
+        struct stat st;
+        while ((e = readdir(dir)) != NULL)
+        {
+            size_t len = strlen(e->d_name);
+            if (len < 4 || strcmp(e->d_name + len - 4, ".ssi") != 0)
+            {
+                continue;
+            }
+            cacheEntry f;
+            f.path = cacheDir + "/" + e->d_name;
+            if (stat(f.path.c_str(), &st) != 0)
+            {
+                continue;
+            }
+            f.mtime = st.st_mtime;
+            f.size = (long) st.st_size;
+            total += f.size;
+            files.push_back(f);
+        }
+        closedir(dir);
+
+        std::sort(files.begin(), files.end(),
+            [](const cacheEntry &a, const cacheEntry &b)
+            { return a.mtime < b.mtime; });
+
+        // the new file is kept, mtime has a resolution of one second
+        for (const cacheEntry &f : files)
+        {
+            if (total <= cacheMaxBytes)
+            {
+                break;
+            }
+            if (f.path == file)
+            {
+                continue;
+            }
+            if (unlink(f.path.c_str()) == 0)
+            {
+                total -= f.size;
+                removed++;
+            }
+        }
+    }
+
+    result->rtyp = INT_CMD;
+    result->data = (void*) removed;
     return FALSE;
 }
 
@@ -1231,11 +3462,77 @@ extern "C" int mod_init(SModulFunctions* psModulFunctions)
 
     boxID = setBlackboxStuff(b_bx, "box");
 
+    blackbox *b_bl = (blackbox*) omAlloc0(sizeof(blackbox));
+
+    b_bl->blackbox_Init        = boxlist_Init;
+    b_bl->blackbox_Copy        = boxlist_Copy;
+    b_bl->blackbox_destroy     = boxlist_Destroy;
+    b_bl->blackbox_String      = boxlist_String;
+    b_bl->blackbox_Assign      = boxlist_Assign;
+    b_bl->blackbox_Op1         = boxlist_Op1;
+    b_bl->blackbox_Op2         = boxlist_Op2;
+    b_bl->blackbox_serialize   = boxlist_serialize;
+    b_bl->blackbox_deserialize = boxlist_deserialize;
+
+    boxlistID = setBlackboxStuff(b_bl, "boxlist");
+
     // add additional functions
     psModulFunctions->iiAddCproc("interval.so", "length", FALSE, length);
     psModulFunctions->iiAddCproc("interval.so", "boxSet", FALSE, boxSet);
+    psModulFunctions->iiAddCproc("interval.so", "boxInInterior", FALSE,
+        boxInInterior);
     psModulFunctions->iiAddCproc("interval.so", "evalPolyAtBox", FALSE,
         evalPolyAtBox);
+    psModulFunctions->iiAddCproc("interval.so", "faceExclusion", FALSE,
+        faceExclusion);
+    psModulFunctions->iiAddCproc("interval.so", "boxlistToList", FALSE,
+        boxlistToList);
+    psModulFunctions->iiAddCproc("interval.so", "boxlistExclude", FALSE,
+        boxlistExclude);
+    psModulFunctions->iiAddCproc("interval.so", "boxlistSplit", FALSE,
+        boxlistSplit);
+    psModulFunctions->iiAddCproc("interval.so", "evalIdealAtBoxes", FALSE,
+        evalIdealAtBoxes);
+    psModulFunctions->iiAddCproc("interval.so", "ivmatProduct", FALSE,
+        ivmatProduct);
+    psModulFunctions->iiAddCproc("interval.so", "ivmatApply", FALSE,
+        ivmatApply);
+    psModulFunctions->iiAddCproc("interval.so", "intervalStats", FALSE,
+        intervalStats);
+    psModulFunctions->iiAddCproc("interval.so", "intervalStatsClear", FALSE,
+        intervalStatsClear);
+    psModulFunctions->iiAddCproc("interval.so", "traceStart", FALSE,
+        traceStart);
+    psModulFunctions->iiAddCproc("interval.so", "traceStop", FALSE, traceStop);
+    psModulFunctions->iiAddCproc("interval.so", "traceActive", FALSE,
+        traceActive);
+    psModulFunctions->iiAddCproc("interval.so", "traceBox", FALSE, traceBox);
+    psModulFunctions->iiAddCproc("interval.so", "hyperplaneCacheGet", FALSE,
+        hyperplaneCacheGet);
+    psModulFunctions->iiAddCproc("interval.so", "hyperplaneCachePut", FALSE,
+        hyperplaneCachePut);
+    psModulFunctions->iiAddCproc("interval.so", "hyperplaneCacheClear", FALSE,
+        hyperplaneCacheClear);
+    psModulFunctions->iiAddCproc("interval.so", "hyperplaneCacheStats", FALSE,
+        hyperplaneCacheStats);
+    psModulFunctions->iiAddCproc("interval.so", "rootIndexContains", FALSE,
+        rootIndexContains);
+    psModulFunctions->iiAddCproc("interval.so", "rootIndexInsert", FALSE,
+        rootIndexInsert);
+    psModulFunctions->iiAddCproc("interval.so", "rootIndexClear", FALSE,
+        rootIndexClear);
+    psModulFunctions->iiAddCproc("interval.so", "rootIndexStats", FALSE,
+        rootIndexStats);
+    psModulFunctions->iiAddCproc("interval.so", "isolateRealRoots", FALSE,
+        isolateRealRoots);
+    psModulFunctions->iiAddCproc("interval.so", "rootCacheOpen", FALSE,
+        rootCacheOpen);
+    psModulFunctions->iiAddCproc("interval.so", "rootCacheClose", FALSE,
+        rootCacheClose);
+    psModulFunctions->iiAddCproc("interval.so", "rootCacheFile", FALSE,
+        rootCacheFile);
+    psModulFunctions->iiAddCproc("interval.so", "rootCacheCommit", FALSE,
+        rootCacheCommit);
 
     // TODO add help strings
 
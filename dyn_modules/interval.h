@@ -2,16 +2,66 @@
 #define INTERVAL_H
 
 #include "Singular/ipid.h"
+#include "intervalCore.h"
 
-struct interval
+#include <vector>
+
+// endpoint policy for intervalCore.h: exact numbers of a coefficient domain
+struct singularEndpoint
+{
+    typedef number value;
+    static constexpr bool exact = true;
+    coeffs cf;
+
+    singularEndpoint(coeffs c) : cf(c) {}
+
+    number init(long a) const { return n_Init(a, cf); }
+    number copy(number a) const { return n_Copy(a, cf); }
+    void destroy(number &a) const { n_Delete(&a, cf); }
+
+    number add(number a, number b, ivcore::rounding) const
+    {
+        number r = n_Add(a, b, cf);
+        n_Normalize(r, cf);
+        return r;
+    }
+    number sub(number a, number b, ivcore::rounding) const
+    {
+        number r = n_Sub(a, b, cf);
+        n_Normalize(r, cf);
+        return r;
+    }
+    number mul(number a, number b, ivcore::rounding) const
+    {
+        number r = n_Mult(a, b, cf);
+        n_Normalize(r, cf);
+        return r;
+    }
+    number pow(number a, int p, ivcore::rounding) const
+    {
+        number r;
+        n_Power(a, p, &r, cf);
+        return r;
+    }
+    number neg(number a) const { return n_InpNeg(n_Copy(a, cf), cf); }
+
+    int sign(number a) const
+    {
+        return n_IsZero(a, cf) ? 0 : (n_GreaterZero(a, cf) ? 1 : -1);
+    }
+    bool greater(number a, number b) const { return n_Greater(a, b, cf); }
+    bool equal(number a, number b) const { return n_Equal(a, b, cf); }
+};
+
+// the blackbox type is the instantiation of ivcore::Interval with numbers
+struct interval : public ivcore::Interval<singularEndpoint>
 {
-    number lower;
-    number upper;
     ring R;
 
     interval();
     interval(number);
     interval(number, number);
+    interval(number, number, ring);
     interval(interval*);
     ~interval();
 };
@@ -22,14 +72,79 @@ struct box
     ring R;
 
     box();
+    box(ring);
     box(box*);
     ~box();
 
     box& setInterval(int, interval*);
+
+    // allows to use box with the templates in intervalCore.h
+    const interval& operator[](int i) const { return *intervals[i]; }
+};
+
+typedef ivcore::Interval<singularEndpoint> boxlistInterval;
+
+// endpoints of many boxes of one ring in one array, the intervals of box j
+// are ivs[j*N], .., ivs[j*N+N-1]; immutable once built and shared by copies
+struct boxlistData
+{
+    std::vector<boxlistInterval> ivs;
+    ring R;
+    long ref;
+};
+
+struct boxlist
+{
+    boxlistData *d;
+
+    boxlist(ring);
+    boxlist(boxlist*);      // shares the data
+    ~boxlist();
+
+    int size() const { return (int) (d->ivs.size() / d->R->N); }
+    ring R() const { return d->R; }
+
+    // intervals of box j = 0..size()-1, a box for the templates of
+    // intervalCore.h
+    const boxlistInterval* operator[](int j) const
+    {
+        return d->ivs.data() + (size_t) j * d->R->N;
+    }
+
+    // only while building, appends copies of the intervals
+    void append(const box *B);
+    void append(const boxlistInterval *B);
+
+    box* get(int j) const;
+};
+
+// term cursor of a polynomial for ivcore::evalPoly
+struct polyTerms
+{
+    poly p;
+    ring R;
+
+    polyTerms(poly q, ring S) : p(q), R(S) {}
+
+    bool done() const { return p == NULL; }
+    void advance() { pIter(p); }
+    number coef() const { return pGetCoeff(p); }
+    int exp(int i) const { return p_GetExp(p, i+1, R); }
 };
 
 extern int intervalID;
 extern int boxID;
+extern int boxlistID;
+
+// kernel counters, reported by intervalStats()
+struct intervalCounters
+{
+    long evaluations;
+    long multiplications;
+    long boxes;
+};
+
+extern intervalCounters ivCounters;
 
 // helpful functions
 interval* intervalScalarMultiply(number, interval*);
@@ -38,6 +153,11 @@ interval* intervalAdd(interval*, interval*);
 interval* intervalSubtract(interval*, interval*);
 bool intervalEqual(interval*, interval*);
 bool intervalContainsZero(interval*);
+interval* intervalPower(interval*, int);
+interval* intervalEvalPoly(poly, box*);
+double numberToDouble(number, coeffs);
+bool numberToDoubleRounded(number, const coeffs, ivcore::rounding, double&);
+number doubleToNumber(double, const coeffs);
 
 extern "C" int mod_init(SModulFunctions*);
 
@@ -0,0 +1,245 @@
+/*
+ * Micro-benchmarks for the interval kernels of interval.cc.
+ *
+ * Every benchmark is calibrated so that one batch takes at least 10ms, then
+ * REPS batches are timed. Reported are the median and minimum time per
+ * operation and the spread (max - min) / median of the batches, together
+ * with the heap allocations per operation: C++ operator new (interval and
+ * box objects) and GMP (limbs of big numbers). Cells of Singular numbers
+ * come from omalloc bins and are not counted. Build with "make bench".
+ */
+
+#include "Singular/libsingular.h"
+#include "interval.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/*
+ * ALLOCATION COUNTING
+ */
+
+static long allocations = 0;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size);
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// GMP allocations, counted in front of the functions set by siInit
+static long gmpAllocations = 0;
+static void *(*gmpAlloc)(size_t);
+static void *(*gmpRealloc)(void*, size_t, size_t);
+static void (*gmpFree)(void*, size_t);
+
+static void* countingAlloc(size_t size)
+{
+    gmpAllocations++;
+    return gmpAlloc(size);
+}
+
+static void* countingRealloc(void *p, size_t old, size_t size)
+{
+    gmpAllocations++;
+    return gmpRealloc(p, old, size);
+}
+
+static void countGmpAllocations()
+{
+    mp_get_memory_functions(&gmpAlloc, &gmpRealloc, &gmpFree);
+    mp_set_memory_functions(countingAlloc, countingRealloc, gmpFree);
+}
+
+/*
+ * TIMING
+ */
+
+#define REPS 15
+#define MIN_BATCH_NS 10000000.0
+
+template <class F>
+static void bench(const char *name, F op)
+{
+    typedef std::chrono::steady_clock clock;
+    long i, batch = 1;
+    double ns;
+
+    // calibrate batch size
+    while (1)
+    {
+        clock::time_point t0 = clock::now();
+        for (i = 0; i < batch; i++) { op(); }
+        ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        if (ns >= MIN_BATCH_NS) { break; }
+        batch *= 2;
+    }
+
+    std::vector<double> times;
+    long allocs = allocations, gmp = gmpAllocations;
+    for (int r = 0; r < REPS; r++)
+    {
+        clock::time_point t0 = clock::now();
+        for (i = 0; i < batch; i++) { op(); }
+        ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        times.push_back(ns / batch);
+    }
+    allocs = allocations - allocs;
+    gmp = gmpAllocations - gmp;
+
+    std::sort(times.begin(), times.end());
+    double median = times[REPS/2];
+
+    printf("%-28s %12.1f %12.1f %8.3f %10.1f %10.1f\n", name, median,
+        times[0], (times[REPS-1] - times[0]) / median,
+        (double) allocs / (REPS * batch), (double) gmp / (REPS * batch));
+}
+
+/*
+ * SETUP
+ */
+
+static number rational(long a, long b, const coeffs cf)
+{
+    number n = n_Init(a, cf), d = n_Init(b, cf);
+    number q = n_Div(n, d, cf);
+    n_Normalize(q, cf);
+    n_Delete(&n, cf);
+    n_Delete(&d, cf);
+    return q;
+}
+
+// ring with n variables x1..xn, set as currRing
+static ring benchRing(int n)
+{
+    char **names = (char**) omAlloc(n * sizeof(char*));
+    char buf[16];
+    for (int i = 0; i < n; i++)
+    {
+        snprintf(buf, sizeof(buf), "x%d", i + 1);
+        names[i] = omStrDup(buf);
+    }
+    ring R = rDefault(0, n, names);
+    rChangeCurrRing(R);
+    return R;
+}
+
+// dense polynomial (1 + x1 + ... + xn)^d
+static poly densePoly(int d, const ring R)
+{
+    poly s = p_One(R), v;
+    for (int i = 1; i <= R->N; i++)
+    {
+        v = p_One(R);
+        p_SetExp(v, i, 1, R);
+        p_Setm(v, R);
+        s = p_Add_q(s, v, R);
+    }
+    return p_Power(s, d, R);
+}
+
+// box [-3/2, 5/4] x ... x [-3/2, 5/4] in currRing
+static box* benchBox()
+{
+    box *B = new box();
+    for (int i = 0; i < currRing->N; i++)
+    {
+        B->setInterval(i, new interval(rational(-3, 2, currRing->cf),
+            rational(5, 4, currRing->cf)));
+    }
+    return B;
+}
+
+int main(int, char **argv)
+{
+    siInit(argv[0]);
+    countGmpAllocations();
+
+    printf("%-28s %12s %12s %8s %10s %10s\n", "benchmark", "median ns/op",
+        "min ns/op", "spread", "new/op", "gmp/op");
+
+    /* primitive operations */
+    ring R = benchRing(1);
+    const coeffs cf = R->cf;
+    interval *I = new interval(rational(-3, 2, cf), rational(5, 4, cf)),
+             *J = new interval(rational(1, 3, cf), rational(7, 2, cf));
+    number a = rational(-2, 3, cf);
+
+    bench("intervalAdd", [&]() { delete intervalAdd(I, J); });
+    bench("intervalSubtract", [&]() { delete intervalSubtract(I, J); });
+    bench("intervalMultiply", [&]() { delete intervalMultiply(I, J); });
+    bench("intervalScalarMultiply", [&]() {
+        delete intervalScalarMultiply(a, I); });
+    bench("intervalPower^3", [&]() { delete intervalPower(I, 3); });
+    bench("intervalPower^8", [&]() { delete intervalPower(I, 8); });
+    bench("intervalContainsZero", [&]() { intervalContainsZero(I); });
+
+    delete I;
+    delete J;
+    n_Delete(&a, cf);
+
+    /* polynomial evaluation and boxes */
+    const int dims[] = {1, 2, 3, 5};
+    const int degs[] = {2, 4, 8};
+    char name[64];
+
+    for (int n : dims)
+    {
+        R = benchRing(n);
+        box *B = benchBox();
+
+        for (int d : degs)
+        {
+            poly p = densePoly(d, R);
+            snprintf(name, sizeof(name), "intervalEvalPoly n=%d d=%d", n, d);
+            bench(name, [&]() { delete intervalEvalPoly(p, B); });
+            p_Delete(&p, R);
+        }
+
+        snprintf(name, sizeof(name), "box() n=%d", n);
+        bench(name, [&]() { delete new box(); });
+        snprintf(name, sizeof(name), "box(box*) n=%d", n);
+        bench(name, [&]() { delete new box(B); });
+
+        delete B;
+    }
+
+    /* midpoint-radius matrix products, interval entries [k, k + 1/64] */
+    const int sizes[] = {2, 10, 30};
+    for (int n : sizes)
+    {
+        std::vector<double> lo(n*n), up(n*n), Clo(n*n), Cup(n*n);
+        for (int i = 0; i < n*n; i++)
+        {
+            lo[i] = (i % 7) - 3;
+            up[i] = lo[i] + 1.0/64;
+        }
+        snprintf(name, sizeof(name), "midradMatMul n=%d", n);
+        bench(name, [&]() { ivcore::midradMatMul(lo.data(), up.data(),
+            lo.data(), up.data(), n, n, n, Clo.data(), Cup.data()); });
+        snprintf(name, sizeof(name), "midradMatVec n=%d", n);
+        bench(name, [&]() { ivcore::midradMatMul(lo.data(), up.data(),
+            lo.data(), up.data(), n, n, 1, Clo.data(), Cup.data()); });
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * Explicit instantiations of intervalCore.h for the endpoint policies that do
+ * not need Singular, so that the core builds and links on its own
+ * ("make core"). The Singular instantiation lives in interval.cc.
+ */
+
+#include "intervalCore.h"
+
+namespace ivcore
+{
+
+#define INSTANTIATE(E)                                                        \
+    template Interval<E> add(const E&, const Interval<E>&, const Interval<E>&);\
+    template Interval<E> sub(const E&, const Interval<E>&, const Interval<E>&);\
+    template Interval<E> mul(const E&, const Interval<E>&, const Interval<E>&);\
+    template Interval<E> scalarMul(const E&, E::value, const Interval<E>&);    \
+    template Interval<E> pow(const E&, const Interval<E>&, int);               \
+    template bool equal(const E&, const Interval<E>&, const Interval<E>&);     \
+    template bool containsZero(const E&, const Interval<E>&);                  \
+    template E::value width(const E&, const Interval<E>&);                     \
+    template E::value boxWidth(const E&, Interval<E>* const&, int);            \
+    template bool boxIsInterior(const E&, Interval<E>* const&,                 \
+        Interval<E>* const&, int);                                             \
+    template bool boxIntersect(const E&, Interval<E>* const&,                  \
+        Interval<E>* const&, int, Interval<E>*);
+
+INSTANTIATE(doubleEndpoint)
+INSTANTIATE(dyadicEndpoint)
+#ifdef HAVE_MPFR
+INSTANTIATE(mpfrEndpoint)
+#endif
+
+#undef INSTANTIATE
+
+} // namespace ivcore
@@ -0,0 +1,659 @@
+#ifndef INTERVAL_CORE_H
+#define INTERVAL_CORE_H
+
+/*
+ * Interval arithmetic and box logic, generic over the representation of the
+ * endpoints. This header does not depend on Singular; the Singular types in
+ * interval.h are one instantiation (exact rationals of a coefficient domain).
+ *
+ * An endpoint policy E provides
+ *
+ *      typedef ... value;
+ *      static constexpr bool exact;    // true if no rounding ever happens
+ *      value init(long) const;
+ *      value copy(value) const;
+ *      void destroy(value&) const;
+ *      value add(value, value, rounding) const;
+ *      value sub(value, value, rounding) const;
+ *      value mul(value, value, rounding) const;
+ *      value pow(value, int, rounding) const;  // only called for value >= 0
+ *      value neg(value) const;                 // exact
+ *      int sign(value) const;
+ *      bool greater(value, value) const;
+ *      bool equal(value, value) const;
+ *
+ * where rounding is the direction the exact result has to be rounded to.
+ * Policies carry their context (coefficient domain, precision) explicitly,
+ * so no global state is involved and the double and dyadic instantiations
+ * inline completely.
+ */
+
+#include <cfenv>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifdef HAVE_MPFR
+#include <mpfr.h>
+#endif
+
+namespace ivcore
+{
+
+enum rounding { down, up };
+
+template <class E>
+struct Interval
+{
+    typename E::value lower;
+    typename E::value upper;
+};
+
+template <class E>
+inline Interval<E> make(typename E::value lo, typename E::value up)
+{
+    Interval<E> I;
+    I.lower = lo;
+    I.upper = up;
+    return I;
+}
+
+template <class E>
+inline Interval<E> point(const E &e, long a)
+{
+    return make<E>(e.init(a), e.init(a));
+}
+
+template <class E>
+inline Interval<E> copy(const E &e, const Interval<E> &I)
+{
+    return make<E>(e.copy(I.lower), e.copy(I.upper));
+}
+
+template <class E>
+inline void release(const E &e, Interval<E> &I)
+{
+    e.destroy(I.lower);
+    e.destroy(I.upper);
+}
+
+/*
+ * ARITHMETIC
+ */
+
+template <class E>
+inline Interval<E> add(const E &e, const Interval<E> &I, const Interval<E> &J)
+{
+    return make<E>(e.add(I.lower, J.lower, down), e.add(I.upper, J.upper, up));
+}
+
+template <class E>
+inline Interval<E> sub(const E &e, const Interval<E> &I, const Interval<E> &J)
+{
+    return make<E>(e.sub(I.lower, J.upper, down), e.sub(I.upper, J.lower, up));
+}
+
+template <class E>
+inline Interval<E> scalarMul(const E &e, typename E::value a,
+    const Interval<E> &I)
+{
+    if (e.sign(a) >= 0)
+    {
+        return make<E>(e.mul(a, I.lower, down), e.mul(a, I.upper, up));
+    }
+    return make<E>(e.mul(a, I.upper, down), e.mul(a, I.lower, up));
+}
+
+template <class E>
+inline Interval<E> mul(const E &e, const Interval<E> &I, const Interval<E> &J)
+{
+    typename E::value lo[4], hi[4];
+    const typename E::value *a[2] = {&I.lower, &I.upper},
+                            *b[2] = {&J.lower, &J.upper};
+    int i, imin = 0, imax = 0;
+
+    // exact products need not be computed twice
+    for (i = 0; i < 4; i++)
+    {
+        lo[i] = e.mul(*a[i/2], *b[i%2], down);
+        if (!E::exact) { hi[i] = e.mul(*a[i/2], *b[i%2], up); }
+    }
+    typename E::value *h = E::exact ? lo : hi;
+    for (i = 1; i < 4; i++)
+    {
+        if (e.greater(lo[imin], lo[i])) { imin = i; }
+        if (e.greater(h[i], h[imax])) { imax = i; }
+    }
+
+    Interval<E> R = make<E>(e.copy(lo[imin]), e.copy(h[imax]));
+    for (i = 0; i < 4; i++)
+    {
+        e.destroy(lo[i]);
+        if (!E::exact) { e.destroy(hi[i]); }
+    }
+    return R;
+}
+
+// signed power of a single endpoint, rounded to dir
+template <class E>
+inline typename E::value powSigned(const E &e, typename E::value a, int p,
+    rounding dir)
+{
+    if (e.sign(a) >= 0 || p % 2 == 0)
+    {
+        typename E::value m = e.sign(a) >= 0 ? e.copy(a) : e.neg(a),
+                          r = e.pow(m, p, dir);
+        e.destroy(m);
+        return r;
+    }
+    // a < 0, p odd: a^p = -|a|^p, so round magnitude the other way
+    typename E::value m = e.neg(a),
+                      r = e.pow(m, p, dir == down ? up : down),
+                      s = e.neg(r);
+    e.destroy(m);
+    e.destroy(r);
+    return s;
+}
+
+template <class E>
+inline Interval<E> pow(const E &e, const Interval<E> &I, int p)
+{
+    if (p == 0)
+    {
+        return point(e, 1);
+    }
+    if (p % 2 == 1 || e.sign(I.lower) >= 0)
+    {
+        return make<E>(powSigned(e, I.lower, p, down),
+            powSigned(e, I.upper, p, up));
+    }
+    if (e.sign(I.upper) <= 0)
+    {
+        return make<E>(powSigned(e, I.upper, p, down),
+            powSigned(e, I.lower, p, up));
+    }
+
+    // even power of interval containing zero
+    typename E::value l = powSigned(e, I.lower, p, up),
+                      u = powSigned(e, I.upper, p, up);
+    if (e.greater(l, u))
+    {
+        e.destroy(u);
+        return make<E>(e.init(0), l);
+    }
+    e.destroy(l);
+    return make<E>(e.init(0), u);
+}
+
+template <class E>
+inline bool equal(const E &e, const Interval<E> &I, const Interval<E> &J)
+{
+    return e.equal(I.lower, J.lower) && e.equal(I.upper, J.upper);
+}
+
+template <class E>
+inline bool containsZero(const E &e, const Interval<E> &I)
+{
+    return e.sign(I.lower) <= 0 && e.sign(I.upper) >= 0;
+}
+
+// upper bound for upper - lower
+template <class E>
+inline typename E::value width(const E &e, const Interval<E> &I)
+{
+    return e.sub(I.upper, I.lower, up);
+}
+
+/*
+ * BOX LOGIC
+ *
+ * A box is anything with B[i] of type Interval<E>, i = 0..n-1.
+ */
+
+// maximal width of the intervals of B
+template <class E, class Box>
+typename E::value boxWidth(const E &e, const Box &B, int n)
+{
+    typename E::value w = e.init(0), t;
+    for (int i = 0; i < n; i++)
+    {
+        t = width(e, B[i]);
+        if (e.greater(t, w))
+        {
+            e.destroy(w);
+            w = t;
+        }
+        else
+        {
+            e.destroy(t);
+        }
+    }
+    return w;
+}
+
+// true if A is contained in the interior of B
+template <class E, class BoxA, class BoxB>
+bool boxIsInterior(const E &e, const BoxA &A, const BoxB &B, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!e.greater(A[i].lower, B[i].lower)
+            || !e.greater(B[i].upper, A[i].upper))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// true if A and B intersect, the intersection is written to C (copies)
+template <class E, class BoxA, class BoxB>
+bool boxIntersect(const E &e, const BoxA &A, const BoxB &B, int n,
+    Interval<E> *C)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        const typename E::value &lo = e.greater(A[i].lower, B[i].lower)
+                                      ? A[i].lower : B[i].lower,
+                                &up = e.greater(A[i].upper, B[i].upper)
+                                      ? B[i].upper : A[i].upper;
+        if (e.greater(lo, up))
+        {
+            while (i > 0) { release(e, C[--i]); }
+            return false;
+        }
+        C[i] = make<E>(e.copy(lo), e.copy(up));
+    }
+    return true;
+}
+
+/*
+ * Enclosure of a polynomial over a box. The polynomial is given by a term
+ * cursor T with
+ *
+ *      bool done() const;
+ *      void advance();
+ *      typename E::value coef() const;     // exact coefficient
+ *      int exp(int i) const;               // exponent of variable i = 0..n-1
+ */
+template <class E, class Box, class T>
+Interval<E> evalPoly(const E &e, const Box &B, int n, T term)
+{
+    Interval<E> res = point(e, 0), monom, tmp, p;
+    int i, k;
+
+    for (; !term.done(); term.advance())
+    {
+        monom = point(e, 1);
+        for (i = 0; i < n; i++)
+        {
+            k = term.exp(i);
+            if (k == 0) { continue; }
+
+            p = pow(e, B[i], k);
+            tmp = mul(e, monom, p);
+            release(e, p);
+            release(e, monom);
+            monom = tmp;
+        }
+
+        tmp = scalarMul(e, term.coef(), monom);
+        release(e, monom);
+
+        monom = add(e, res, tmp);
+        release(e, res);
+        release(e, tmp);
+        res = monom;
+    }
+    return res;
+}
+
+/*
+ * MIDPOINT-RADIUS MATRIX PRODUCTS
+ *
+ * Rump, Fast and parallel interval arithmetic, BIT 39 (1999): with A and B
+ * in midpoint-radius form <mA, rA>, <mB, rB> the product is enclosed by
+ *
+ *      mC = C1 + (C2 - C1) / 2,
+ *      rC = (mC - C1) + (|mA| + rA) rB + rA |mB|,
+ *
+ * where C1 and C2 are mA mB computed with rounding down and up, and all of
+ * mC, rC with rounding up. So an interval product costs four ordinary
+ * floating-point matrix products. Needs -frounding-math.
+ */
+
+// C = A B, row major, A m x p, B p x n, in the current rounding mode
+inline void gemm(const double *A, const double *B, int m, int p, int n,
+    double *C)
+{
+    int i, j, k;
+    for (i = 0; i < m*n; i++) { C[i] = 0; }
+    for (i = 0; i < m; i++)
+    {
+        for (k = 0; k < p; k++)
+        {
+            const double a = A[i*p + k];
+            if (a == 0) { continue; }
+            const double *b = B + k*n;
+            double *c = C + i*n;
+            for (j = 0; j < n; j++) { c[j] += a * b[j]; }
+        }
+    }
+}
+
+// midpoint and radius of [lo, up], rounding upward must be set
+inline void midrad(const double *lo, const double *up, int k, double *mid,
+    double *rad)
+{
+    for (int i = 0; i < k; i++)
+    {
+        mid[i] = lo[i] + (up[i] - lo[i]) * 0.5;
+        rad[i] = mid[i] - lo[i];
+    }
+}
+
+/*
+ * Enclosure [Clo, Cup] of the product of the m x p matrix [Alo, Aup] and the
+ * p x n matrix [Blo, Bup], all row major. Returns false, leaving C
+ * undefined, if an entry overflows or if rounding errors are not negligible
+ * against the radius of the result, i.e. the operands are so narrow that
+ * exact arithmetic should be used instead.
+ */
+inline bool midradMatMul(const double *Alo, const double *Aup,
+    const double *Blo, const double *Bup, int m, int p, int n,
+    double *Clo, double *Cup)
+{
+    std::vector<double> mA(m*p), rA(m*p), mB(p*n), rB(p*n),
+                        C1(m*n), C2(m*n), T(m*n);
+    const int mode = std::fegetround();
+    int i;
+
+    std::fesetround(FE_UPWARD);
+    midrad(Alo, Aup, m*p, mA.data(), rA.data());
+    midrad(Blo, Bup, p*n, mB.data(), rB.data());
+
+    std::fesetround(FE_DOWNWARD);
+    gemm(mA.data(), mB.data(), m, p, n, C1.data());
+
+    std::fesetround(FE_UPWARD);
+    gemm(mA.data(), mB.data(), m, p, n, C2.data());
+
+    // C2 := mC, Cup := rC
+    for (i = 0; i < m*n; i++)
+    {
+        C2[i] = C1[i] + (C2[i] - C1[i]) * 0.5;
+        Cup[i] = C2[i] - C1[i];
+    }
+
+    // (|mA| + rA) rB + rA |mB|
+    for (i = 0; i < m*p; i++) { mA[i] = std::fabs(mA[i]); }
+    for (i = 0; i < p*n; i++) { mB[i] = std::fabs(mB[i]); }
+    std::vector<double> S(m*p);
+    for (i = 0; i < m*p; i++) { S[i] = mA[i] + rA[i]; }
+    gemm(S.data(), rB.data(), m, p, n, T.data());
+    for (i = 0; i < m*n; i++) { Cup[i] += T[i]; }
+    gemm(rA.data(), mB.data(), m, p, n, T.data());
+
+    // rounding errors of the products are about p ulp of |mA| |mB|
+    gemm(mA.data(), mB.data(), m, p, n, C1.data());
+
+    bool ok = true;
+    const double u = (p + 2) * DBL_EPSILON;
+    for (i = 0; i < m*n; i++)
+    {
+        Cup[i] += T[i];
+        if (!std::isfinite(C2[i]) || !std::isfinite(Cup[i])
+            || 8 * u * C1[i] > Cup[i])
+        {
+            ok = false;
+            break;
+        }
+        // mC - rC rounded down
+        Clo[i] = -(Cup[i] - C2[i]);
+        Cup[i] = C2[i] + Cup[i];
+    }
+
+    std::fesetround(mode);
+    return ok;
+}
+
+/*
+ * ENDPOINT POLICIES
+ */
+
+// binary64 with outward rounding by one ulp after every operation
+struct doubleEndpoint
+{
+    typedef double value;
+    static constexpr bool exact = false;
+
+    static double round(double a, rounding dir)
+    {
+        return std::nextafter(a, dir == down ? -HUGE_VAL : HUGE_VAL);
+    }
+
+    double init(long a) const { return (double) a; }
+    double copy(double a) const { return a; }
+    void destroy(double&) const {}
+    double add(double a, double b, rounding dir) const
+        { return round(a + b, dir); }
+    double sub(double a, double b, rounding dir) const
+        { return round(a - b, dir); }
+    double mul(double a, double b, rounding dir) const
+    {
+        double r = a * b;
+        // products with zero are exact
+        return (a == 0 || b == 0) ? r : round(r, dir);
+    }
+    double pow(double a, int p, rounding dir) const
+    {
+        double r = 1;
+        for (; p > 0; p--) { r = mul(r, a, dir); }
+        return r;
+    }
+    double neg(double a) const { return -a; }
+    int sign(double a) const { return (a > 0) - (a < 0); }
+    bool greater(double a, double b) const { return a > b; }
+    bool equal(double a, double b) const { return a == b; }
+};
+
+/*
+ * m * 2^exp with a 64 bit mantissa, normalised to 2^61 <= |m| < 2^62 (or
+ * m == 0), so that comparisons need no alignment.
+ */
+struct dyadic
+{
+    int64_t m;
+    int exp;
+};
+
+struct dyadicEndpoint
+{
+    typedef dyadic value;
+    static constexpr bool exact = false;
+
+    static constexpr int64_t HI = (int64_t) 1 << 62;
+    static constexpr int64_t LO = (int64_t) 1 << 61;
+
+    // shift right by k >= 1 bits, rounding to dir
+    static __int128 shift(__int128 m, int k, rounding dir)
+    {
+        if (k >= 126)
+        {
+            return m == 0 ? 0 : (dir == down ? (m < 0 ? -1 : 0)
+                                             : (m > 0 ? 1 : 0));
+        }
+        // >> rounds to -infinity
+        return dir == down ? m >> k : -((-m) >> k);
+    }
+
+    static dyadic normalise(__int128 m, int exp, rounding dir)
+    {
+        dyadic d;
+        if (m == 0)
+        {
+            d.m = 0;
+            d.exp = 0;
+            return d;
+        }
+        while (m >= HI || m <= -HI)
+        {
+            int k = 1;
+            __int128 a = m < 0 ? -m : m;
+            while ((a >> k) >= HI) { k++; }
+            m = shift(m, k, dir);
+            exp += k;
+        }
+        while (m < LO && m > -LO)
+        {
+            m *= 2;
+            exp--;
+        }
+        d.m = (int64_t) m;
+        d.exp = exp;
+        return d;
+    }
+
+    dyadic init(long a) const { return normalise(a, 0, down); }
+    dyadic copy(dyadic a) const { return a; }
+    void destroy(dyadic&) const {}
+
+    dyadic add(dyadic a, dyadic b, rounding dir) const
+    {
+        if (a.m == 0) { return b; }
+        if (b.m == 0) { return a; }
+        if (a.exp < b.exp) { dyadic t = a; a = b; b = t; }
+
+        // a has the larger exponent, align b to a.exp - 62
+        int d = a.exp - b.exp;
+        __int128 ma = (__int128) a.m << 62, mb = b.m;
+        int e = a.exp - 62;
+        if (d <= 62)
+        {
+            mb <<= 62 - d;
+        }
+        else
+        {
+            mb = shift(mb, d - 62, dir);
+        }
+        return normalise(ma + mb, e, dir);
+    }
+
+    dyadic sub(dyadic a, dyadic b, rounding dir) const
+    {
+        return add(a, neg(b), dir);
+    }
+
+    dyadic mul(dyadic a, dyadic b, rounding dir) const
+    {
+        return normalise((__int128) a.m * b.m, a.exp + b.exp, dir);
+    }
+
+    dyadic pow(dyadic a, int p, rounding dir) const
+    {
+        dyadic r = init(1);
+        for (; p > 0; p--) { r = mul(r, a, dir); }
+        return r;
+    }
+
+    dyadic neg(dyadic a) const { a.m = -a.m; return a; }
+    int sign(dyadic a) const { return (a.m > 0) - (a.m < 0); }
+
+    bool greater(dyadic a, dyadic b) const
+    {
+        if (sign(a) != sign(b)) { return sign(a) > sign(b); }
+        if (a.m == 0 || a.exp == b.exp) { return a.m > b.m; }
+        // same sign, larger exponent means larger magnitude
+        return a.m > 0 ? a.exp > b.exp : a.exp < b.exp;
+    }
+
+    bool equal(dyadic a, dyadic b) const
+    {
+        return a.m == b.m && (a.m == 0 || a.exp == b.exp);
+    }
+
+    double toDouble(dyadic a) const { return std::ldexp((double) a.m, a.exp); }
+};
+
+#ifdef HAVE_MPFR
+// MPFR numbers of fixed precision, values are owned like Singular numbers
+struct mpfrEndpoint
+{
+    typedef mpfr_ptr value;
+    static constexpr bool exact = false;
+    mpfr_prec_t prec;
+
+    mpfrEndpoint(mpfr_prec_t p) : prec(p) {}
+
+    static mpfr_rnd_t rnd(rounding dir)
+    {
+        return dir == down ? MPFR_RNDD : MPFR_RNDU;
+    }
+
+    mpfr_ptr alloc() const
+    {
+        mpfr_ptr a = new __mpfr_struct;
+        mpfr_init2(a, prec);
+        return a;
+    }
+
+    mpfr_ptr init(long a) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_set_si(r, a, MPFR_RNDN);
+        return r;
+    }
+    mpfr_ptr copy(mpfr_ptr a) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_set(r, a, MPFR_RNDN);
+        return r;
+    }
+    void destroy(mpfr_ptr &a) const
+    {
+        mpfr_clear(a);
+        delete a;
+        a = NULL;
+    }
+    mpfr_ptr add(mpfr_ptr a, mpfr_ptr b, rounding dir) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_add(r, a, b, rnd(dir));
+        return r;
+    }
+    mpfr_ptr sub(mpfr_ptr a, mpfr_ptr b, rounding dir) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_sub(r, a, b, rnd(dir));
+        return r;
+    }
+    mpfr_ptr mul(mpfr_ptr a, mpfr_ptr b, rounding dir) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_mul(r, a, b, rnd(dir));
+        return r;
+    }
+    mpfr_ptr pow(mpfr_ptr a, int p, rounding dir) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_pow_ui(r, a, p, rnd(dir));
+        return r;
+    }
+    mpfr_ptr neg(mpfr_ptr a) const
+    {
+        mpfr_ptr r = alloc();
+        mpfr_neg(r, a, MPFR_RNDN);
+        return r;
+    }
+    int sign(mpfr_ptr a) const { return mpfr_sgn(a); }
+    bool greater(mpfr_ptr a, mpfr_ptr b) const { return mpfr_greater_p(a, b); }
+    bool equal(mpfr_ptr a, mpfr_ptr b) const { return mpfr_equal_p(a, b); }
+};
+#endif
+
+} // namespace ivcore
+
+#endif
+/* INTERVAL_CORE_H */
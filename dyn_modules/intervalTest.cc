@@ -0,0 +1,423 @@
+/*
+ * Unit tests of intervalCore.h without the interpreter.
+ *
+ * Every floating endpoint policy (double, dyadic and, with HAVE_MPFR, MPFR)
+ * is run on outward rounded copies of random rational intervals and checked
+ * against the exact rational instantiation used by interval.so: results
+ * have to enclose the exact results. Box logic on exactly representable
+ * endpoints has to agree with the exact one. Build and run with
+ * "make test", the exit status is the number of failed checks (at most 255).
+ */
+
+#include "Singular/libsingular.h"
+#include "interval.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char *policy, const char *what, int trial)
+{
+    if (!ok)
+    {
+        failures++;
+        printf("FAIL %s %s (trial %d)\n", policy, what, trial);
+    }
+}
+
+/*
+ * CONVERSIONS
+ *
+ * A converter C for policy E provides
+ *
+ *      E::value from(double) const;        // exact
+ *      number to(E::value, coeffs) const;  // exact
+ */
+
+// m * 2^k as number of cf
+static number scaledNumber(mpz_t m, long k, const coeffs cf)
+{
+    mpq_t x;
+    mpq_init(x);
+    mpq_set_z(x, m);
+    if (k >= 0) { mpq_mul_2exp(x, x, k); }
+    else        { mpq_div_2exp(x, x, -k); }
+
+    number num = n_InitMPZ(mpq_numref(x), cf),
+           den = n_InitMPZ(mpq_denref(x), cf);
+    number r = n_Div(num, den, cf);
+    n_Normalize(r, cf);
+    n_Delete(&num, cf);
+    n_Delete(&den, cf);
+    mpq_clear(x);
+    return r;
+}
+
+struct doubleConverter
+{
+    double from(double d) const { return d; }
+    number to(double d, const coeffs cf) const { return doubleToNumber(d, cf); }
+};
+
+struct dyadicConverter
+{
+    ivcore::dyadic from(double d) const
+    {
+        int k;
+        double f = std::frexp(d, &k);
+        // f * 2^53 is an integer of at most 53 bits
+        return ivcore::dyadicEndpoint::normalise(
+            (__int128) std::ldexp(f, 53), k - 53, ivcore::down);
+    }
+    number to(ivcore::dyadic d, const coeffs cf) const
+    {
+        mpz_t m;
+        mpz_init_set_si(m, d.m);
+        number r = scaledNumber(m, d.exp, cf);
+        mpz_clear(m);
+        return r;
+    }
+};
+
+#ifdef HAVE_MPFR
+struct mpfrConverter
+{
+    const ivcore::mpfrEndpoint &e;
+
+    mpfrConverter(const ivcore::mpfrEndpoint &f) : e(f) {}
+
+    mpfr_ptr from(double d) const
+    {
+        mpfr_ptr r = e.alloc();
+        mpfr_set_d(r, d, MPFR_RNDN);
+        return r;
+    }
+    number to(mpfr_ptr a, const coeffs cf) const
+    {
+        mpz_t m;
+        mpz_init(m);
+        long k = mpfr_get_z_2exp(m, a);
+        number r = scaledNumber(m, k, cf);
+        mpz_clear(m);
+        return r;
+    }
+};
+#endif
+
+/*
+ * EXACT REFERENCE
+ */
+
+typedef ivcore::Interval<singularEndpoint> exact;
+
+static number rational(long a, long b, const coeffs cf)
+{
+    number n = n_Init(a, cf), d = n_Init(b, cf);
+    number q = n_Div(n, d, cf);
+    n_Normalize(q, cf);
+    n_Delete(&n, cf);
+    n_Delete(&d, cf);
+    return q;
+}
+
+// random interval with endpoints a/b, |a| <= 1000, 1 <= b <= 97
+static exact randomInterval(std::mt19937 &g, const coeffs cf)
+{
+    std::uniform_int_distribution<long> num(-1000, 1000), den(1, 97);
+    number a = rational(num(g), den(g), cf), b = rational(num(g), den(g), cf);
+    if (n_Greater(a, b, cf)) { number t = a; a = b; b = t; }
+    return ivcore::make<singularEndpoint>(a, b);
+}
+
+// random interval with endpoints k/64, exactly representable everywhere
+static exact dyadicInterval(std::mt19937 &g, const coeffs cf)
+{
+    std::uniform_int_distribution<long> num(-256, 256);
+    long a = num(g), b = num(g);
+    if (a > b) { long t = a; a = b; b = t; }
+    return ivcore::make<singularEndpoint>(rational(a, 64, cf),
+        rational(b, 64, cf));
+}
+
+// outward rounded copy of X in policy E
+template <class E, class C>
+static ivcore::Interval<E> enclose(const C &c, const exact &X, const coeffs cf)
+{
+    double lo, up;
+    bool ok = numberToDoubleRounded(X.lower, cf, ivcore::down, lo)
+              && numberToDoubleRounded(X.upper, cf, ivcore::up, up);
+    (void) ok;
+    return ivcore::make<E>(c.from(lo), c.from(up));
+}
+
+// true if Y encloses X
+template <class E, class C>
+static bool encloses(const C &c, const ivcore::Interval<E> &Y, const exact &X,
+    const coeffs cf)
+{
+    number lo = c.to(Y.lower, cf), up = c.to(Y.upper, cf);
+    bool ok = !n_Greater(lo, X.lower, cf) && !n_Greater(X.upper, up, cf);
+    n_Delete(&lo, cf);
+    n_Delete(&up, cf);
+    return ok;
+}
+
+// term cursor over coefficient and exponent arrays, n variables
+template <class V>
+struct arrayTerms
+{
+    const V *coefs;
+    const int *exps;
+    int n, terms, t;
+
+    arrayTerms(const V *c, const int *x, int m, int k)
+        : coefs(c), exps(x), n(m), terms(k), t(0) {}
+
+    bool done() const { return t == terms; }
+    void advance() { t++; }
+    V coef() const { return coefs[t]; }
+    int exp(int i) const { return exps[t*n + i]; }
+};
+
+/*
+ * TESTS
+ */
+
+#define TRIALS 500
+#define NVARS 3
+#define NTERMS 6
+
+template <class E, class C>
+static void testPolicy(const char *name, const E &e, const C &c,
+    const coeffs cf)
+{
+    singularEndpoint x(cf);
+    std::mt19937 g(1);
+    std::uniform_int_distribution<int> small(-5, 5), expo(0, 3);
+    typedef ivcore::Interval<E> ival;
+
+    for (int trial = 0; trial < TRIALS; trial++)
+    {
+        exact I = randomInterval(g, cf), J = randomInterval(g, cf), X;
+        ival P = enclose<E>(c, I, cf), Q = enclose<E>(c, J, cf), Y;
+
+        X = ivcore::add(x, I, J);
+        Y = ivcore::add(e, P, Q);
+        check(encloses(c, Y, X, cf), name, "add", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+
+        X = ivcore::sub(x, I, J);
+        Y = ivcore::sub(e, P, Q);
+        check(encloses(c, Y, X, cf), name, "sub", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+
+        X = ivcore::mul(x, I, J);
+        Y = ivcore::mul(e, P, Q);
+        check(encloses(c, Y, X, cf), name, "mul", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+
+        // integer scalars are exact in every policy
+        long k = small(g);
+        number a = n_Init(k, cf);
+        typename E::value b = e.init(k);
+        X = ivcore::scalarMul(x, a, I);
+        Y = ivcore::scalarMul(e, b, P);
+        check(encloses(c, Y, X, cf), name, "scalarMul", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+        n_Delete(&a, cf);
+        e.destroy(b);
+
+        int p = 1 + trial % 6;
+        X = ivcore::pow(x, I, p);
+        Y = ivcore::pow(e, P, p);
+        check(encloses(c, Y, X, cf), name, "pow", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+
+        if (ivcore::containsZero(x, I))
+        {
+            check(ivcore::containsZero(e, P), name, "containsZero", trial);
+        }
+
+        number w = ivcore::width(x, I);
+        typename E::value v = ivcore::width(e, P);
+        number vn = c.to(v, cf);
+        check(!n_Greater(w, vn, cf), name, "width", trial);
+        n_Delete(&w, cf);
+        n_Delete(&vn, cf);
+        e.destroy(v);
+
+        ivcore::release(x, I);
+        ivcore::release(x, J);
+        ivcore::release(e, P);
+        ivcore::release(e, Q);
+
+        /* polynomial enclosure over a box */
+        exact XB[NVARS];
+        ival YB[NVARS];
+        for (int i = 0; i < NVARS; i++)
+        {
+            XB[i] = randomInterval(g, cf);
+            YB[i] = enclose<E>(c, XB[i], cf);
+        }
+        number xc[NTERMS];
+        typename E::value yc[NTERMS];
+        int exps[NTERMS*NVARS];
+        for (int t = 0; t < NTERMS; t++)
+        {
+            k = small(g);
+            xc[t] = n_Init(k, cf);
+            yc[t] = e.init(k);
+            for (int i = 0; i < NVARS; i++) { exps[t*NVARS + i] = expo(g); }
+        }
+        X = ivcore::evalPoly(x, XB, NVARS,
+            arrayTerms<number>(xc, exps, NVARS, NTERMS));
+        Y = ivcore::evalPoly(e, YB, NVARS,
+            arrayTerms<typename E::value>(yc, exps, NVARS, NTERMS));
+        check(encloses(c, Y, X, cf), name, "evalPoly", trial);
+        ivcore::release(x, X);
+        ivcore::release(e, Y);
+        for (int t = 0; t < NTERMS; t++)
+        {
+            n_Delete(&xc[t], cf);
+            e.destroy(yc[t]);
+        }
+        for (int i = 0; i < NVARS; i++)
+        {
+            ivcore::release(x, XB[i]);
+            ivcore::release(e, YB[i]);
+        }
+
+        /* box logic, endpoints exact in every policy */
+        exact XA[NVARS], XC[NVARS];
+        ival YA[NVARS], YC[NVARS];
+        for (int i = 0; i < NVARS; i++)
+        {
+            XA[i] = dyadicInterval(g, cf);
+            XB[i] = dyadicInterval(g, cf);
+            YA[i] = enclose<E>(c, XA[i], cf);
+            YB[i] = enclose<E>(c, XB[i], cf);
+        }
+        check(ivcore::boxIsInterior(x, XA, XB, NVARS)
+              == ivcore::boxIsInterior(e, YA, YB, NVARS),
+              name, "boxIsInterior", trial);
+
+        bool mx = ivcore::boxIntersect(x, XA, XB, NVARS, XC),
+             my = ivcore::boxIntersect(e, YA, YB, NVARS, YC);
+        check(mx == my, name, "boxIntersect", trial);
+        if (mx && my)
+        {
+            for (int i = 0; i < NVARS; i++)
+            {
+                check(encloses(c, YC[i], XC[i], cf), name,
+                    "boxIntersect bounds", trial);
+                ivcore::release(x, XC[i]);
+                ivcore::release(e, YC[i]);
+            }
+        }
+
+        number xw = ivcore::boxWidth(x, XA, NVARS);
+        typename E::value yw = ivcore::boxWidth(e, YA, NVARS);
+        number yn = c.to(yw, cf);
+        check(!n_Greater(xw, yn, cf), name, "boxWidth", trial);
+        n_Delete(&xw, cf);
+        n_Delete(&yn, cf);
+        e.destroy(yw);
+
+        for (int i = 0; i < NVARS; i++)
+        {
+            ivcore::release(x, XA[i]);
+            ivcore::release(x, XB[i]);
+            ivcore::release(e, YA[i]);
+            ivcore::release(e, YB[i]);
+        }
+    }
+}
+
+// midradMatMul against the exact product of the rational matrices
+static void testMidrad(const coeffs cf)
+{
+    singularEndpoint x(cf);
+    doubleConverter c;
+    std::mt19937 g(2);
+    const int n = 6;
+    int used = 0;
+
+    for (int trial = 0; trial < TRIALS / 10; trial++)
+    {
+        std::vector<exact> A(n*n), B(n*n);
+        std::vector<double> Alo(n*n), Aup(n*n), Blo(n*n), Bup(n*n),
+                            Clo(n*n), Cup(n*n);
+        for (int i = 0; i < n*n; i++)
+        {
+            A[i] = randomInterval(g, cf);
+            B[i] = randomInterval(g, cf);
+            numberToDoubleRounded(A[i].lower, cf, ivcore::down, Alo[i]);
+            numberToDoubleRounded(A[i].upper, cf, ivcore::up, Aup[i]);
+            numberToDoubleRounded(B[i].lower, cf, ivcore::down, Blo[i]);
+            numberToDoubleRounded(B[i].upper, cf, ivcore::up, Bup[i]);
+        }
+
+        if (ivcore::midradMatMul(Alo.data(), Aup.data(), Blo.data(),
+                Bup.data(), n, n, n, Clo.data(), Cup.data()))
+        {
+            used++;
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < n; j++)
+                {
+                    exact S = ivcore::point(x, 0), T, U;
+                    for (int k = 0; k < n; k++)
+                    {
+                        T = ivcore::mul(x, A[i*n + k], B[k*n + j]);
+                        U = ivcore::add(x, S, T);
+                        ivcore::release(x, S);
+                        ivcore::release(x, T);
+                        S = U;
+                    }
+                    ivcore::Interval<ivcore::doubleEndpoint> Y =
+                        ivcore::make<ivcore::doubleEndpoint>(Clo[i*n + j],
+                            Cup[i*n + j]);
+                    check(encloses(c, Y, S, cf), "midrad", "matMul", trial);
+                    ivcore::release(x, S);
+                }
+            }
+        }
+
+        for (int i = 0; i < n*n; i++)
+        {
+            ivcore::release(x, A[i]);
+            ivcore::release(x, B[i]);
+        }
+    }
+    // wide random intervals do not need the exact fallback
+    check(used > 0, "midrad", "double path used", used);
+}
+
+int main(int, char **argv)
+{
+    siInit(argv[0]);
+
+    char **names = (char**) omAlloc(sizeof(char*));
+    names[0] = omStrDup("x");
+    ring R = rDefault(0, 1, names);
+    rChangeCurrRing(R);
+    const coeffs cf = R->cf;
+
+    testPolicy("double", ivcore::doubleEndpoint(), doubleConverter(), cf);
+    testPolicy("dyadic", ivcore::dyadicEndpoint(), dyadicConverter(), cf);
+#ifdef HAVE_MPFR
+    ivcore::mpfrEndpoint m(80);
+    testPolicy("mpfr", m, mpfrConverter(m), cf);
+#endif
+    testMidrad(cf);
+
+    printf("%d failures\n", failures);
+    return failures > 255 ? 255 : failures;
+}